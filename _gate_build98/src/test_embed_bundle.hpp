@@ -0,0 +1,35 @@
+// Generated by jpcre2_embed from ../../src/test_embed.manifest, do not edit.
+#ifndef JPCRE2_EMBED_TEST_BUNDLE_HPP
+#define JPCRE2_EMBED_TEST_BUNDLE_HPP
+
+#include "jpcre2.hpp"
+
+namespace test_bundle {
+
+typedef jpcre2::select<char> jp;
+
+namespace detail {
+
+extern char const* const patterns[];
+extern char const* const modifiers[];
+
+} //namespace detail
+
+///All patterns in manifest order.
+std::vector<jp::Regex> const& all();
+
+///date: "(\077<y>\\d{4})-(\077<m>\\d\\d)-(\077<d>\\d\\d)"
+jp::Regex date();
+
+///word: "[a-z]+"
+jp::Regex word();
+
+///quoted: "\"(\077:[^\"\\\\]|\\\\.)*\"\077\077\011tab"
+jp::Regex quoted();
+
+///backslash: "\\\\"
+jp::Regex backslash();
+
+} //namespace test_bundle
+
+#endif
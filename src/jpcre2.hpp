@@ -63,23 +63,67 @@
 #ifndef PCRE2_MAJOR
     #include <pcre2.h>  // pcre2 header
 #endif
+#if PCRE2_MAJOR > 10 || (PCRE2_MAJOR == 10 && PCRE2_MINOR >= 34)
+    #define JPCRE2_HAVE_MAKETABLES_FREE 1 // pcre2_maketables_free()
+#endif
 #include <string>       // std::string, std::wstring
 #include <vector>       // std::vector
 #include <map>          // std::map
+#include <list>         // std::list
+#include <algorithm>    // std::lower_bound, std::stable_sort
+#include <functional>   // std::less
+#include <new>          // placement new
+#include <cstddef>      // std::ptrdiff_t
 #include <cstdio>       // std::fprintf
 #include <climits>      // CHAR_BIT
 #include <cstdlib>      // std::abort()
+#include <stdexcept>    // std::out_of_range
+#include <limits>       // std::numeric_limits
+#include <cerrno>       // errno, ERANGE
 
 #if __cplusplus >= 201103L || _MSVC_LANG >= 201103L
     #define JPCRE2_USE_MINIMUM_CXX_11 1
     #include <utility>
+    #include <atomic>       // std::atomic
+    #include <chrono>       // std::chrono::steady_clock
     #ifndef JPCRE2_USE_FUNCTION_POINTER_CALLBACK
         #include <functional>   // std::function
     #endif
 #endif
+#ifndef JPCRE2_DEFAULT_CACHE_SIZE
+    #define JPCRE2_DEFAULT_CACHE_SIZE 67108864
+#endif
+#ifndef JPCRE2_DEFAULT_JIT_STACK_LIMIT
+    #define JPCRE2_DEFAULT_JIT_STACK_LIMIT 1048576
+#endif
+#ifndef JPCRE2_DEFAULT_ARENA_BLOCK_SIZE
+    #define JPCRE2_DEFAULT_ARENA_BLOCK_SIZE 16384
+#endif
+#if defined(JPCRE2_USE_MINIMUM_CXX_11) && !defined(JPCRE2_DISABLE_THREADS)
+    #define JPCRE2_USE_THREADS 1
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <atomic>
+    #include <memory>
+    #include <future>
+    #include <deque>
+    #include <exception>
+    #include <functional>
+    #include <iterator>
+    #ifndef JPCRE2_DEFAULT_CHUNK_SIZE
+        #define JPCRE2_DEFAULT_CHUNK_SIZE 1048576
+    #endif
+#endif
 #if __cplusplus >= 201703L || _MSVC_LANG >= 201703L
     #define JPCRE2_USE_MINIMUM_CXX_17 1
     #include <optional>
+    #if defined(__has_include)
+        #if __has_include(<memory_resource>)
+            #define JPCRE2_USE_PMR 1
+            #include <memory_resource> // std::pmr
+        #endif
+    #endif
 #else
     #ifdef JPCRE2_UNSET_CAPTURES_NULL
         #error JPCRE2_UNSET_CAPTURES_NULL requires C++17
@@ -147,7 +191,10 @@ namespace ERROR {
      */
     enum {
         INVALID_MODIFIER        = 2,  ///< Invalid modifier was detected
-        INSUFFICIENT_OVECTOR    = 3   ///< Ovector was not big enough during a match
+        INSUFFICIENT_OVECTOR    = 3,  ///< Ovector was not big enough during a match
+        FILE_IO                 = 4,  ///< A file could not be read or written
+        TIMEOUT                 = 5,  ///< A match or replace was stopped by its deadline
+        CANCELLED               = 6   ///< A match or replace was stopped by its cancel token
     };
 }
 
@@ -227,6 +274,7 @@ template<> struct Pcre2Type<8>{
     typedef pcre2_match_context_8 MatchContext;
     typedef pcre2_jit_callback_8 JitCallback;
     typedef pcre2_jit_stack_8 JitStack;
+    typedef pcre2_callout_block_8 CalloutBlock;
 };
 
 template<> struct Pcre2Type<16>{
@@ -240,6 +288,7 @@ template<> struct Pcre2Type<16>{
     typedef pcre2_match_context_16 MatchContext;
     typedef pcre2_jit_callback_16 JitCallback;
     typedef pcre2_jit_stack_16 JitStack;
+    typedef pcre2_callout_block_16 CalloutBlock;
 };
 
 template<> struct Pcre2Type<32>{
@@ -253,6 +302,7 @@ template<> struct Pcre2Type<32>{
     typedef pcre2_match_context_32 MatchContext;
     typedef pcre2_jit_callback_32 JitCallback;
     typedef pcre2_jit_stack_32 JitStack;
+    typedef pcre2_callout_block_32 CalloutBlock;
 };
 
 //wrappers for PCRE2 functions
@@ -272,6 +322,18 @@ template<> struct Pcre2Func<8> {
     static const unsigned char * maketables(Pcre2Type<8>::GeneralContext* gcontext){
         return pcre2_maketables_8(gcontext);
     }
+    #ifdef JPCRE2_HAVE_MAKETABLES_FREE
+    static void maketables_free(Pcre2Type<8>::GeneralContext* gcontext, const unsigned char * tables){
+        pcre2_maketables_free_8(gcontext, tables);
+    }
+    #endif
+    static Pcre2Type<8>::GeneralContext* general_context_create(void* (*private_malloc)(PCRE2_SIZE, void*),
+                                                                  void (*private_free)(void*, void*), void* memory_data){
+        return pcre2_general_context_create_8(private_malloc, private_free, memory_data);
+    }
+    static void general_context_free(Pcre2Type<8>::GeneralContext* gcontext){
+        pcre2_general_context_free_8(gcontext);
+    }
     static int set_character_tables(Pcre2Type<8>::CompileContext * ccontext, const unsigned char * table){
         return pcre2_set_character_tables_8(ccontext, table);
     }
@@ -315,12 +377,27 @@ template<> struct Pcre2Func<8> {
     //~ static void substring_free(Pcre2Type<8>::Pcre2Uchar *buffer){
         //~ pcre2_substring_free_8(buffer);
     //~ }
-    //~ static Pcre2Type<8>::Pcre2Code * code_copy(const Pcre2Type<8>::Pcre2Code *code){
-        //~ return pcre2_code_copy_8(code);
-    //~ }
+    static Pcre2Type<8>::Pcre2Code * code_copy(const Pcre2Type<8>::Pcre2Code *code){
+        return pcre2_code_copy_8(code);
+    }
     static void code_free(Pcre2Type<8>::Pcre2Code *code){
         pcre2_code_free_8(code);
     }
+    static int32_t serialize_encode(const Pcre2Type<8>::Pcre2Code **codes, int32_t number_of_codes,
+                                    uint8_t **serialized_bytes, PCRE2_SIZE *serialized_size,
+                                    Pcre2Type<8>::GeneralContext *gcontext){
+        return pcre2_serialize_encode_8(codes, number_of_codes, serialized_bytes, serialized_size, gcontext);
+    }
+    static int32_t serialize_decode(Pcre2Type<8>::Pcre2Code **codes, int32_t number_of_codes,
+                                    const uint8_t *bytes, Pcre2Type<8>::GeneralContext *gcontext){
+        return pcre2_serialize_decode_8(codes, number_of_codes, bytes, gcontext);
+    }
+    static int32_t serialize_get_number_of_codes(const uint8_t *bytes){
+        return pcre2_serialize_get_number_of_codes_8(bytes);
+    }
+    static void serialize_free(uint8_t *bytes){
+        pcre2_serialize_free_8(bytes);
+    }
     static int get_error_message(  int errorcode,
                             Pcre2Type<8>::Pcre2Uchar *buffer,
                             PCRE2_SIZE bufflen){
@@ -341,6 +418,15 @@ template<> struct Pcre2Func<8> {
                             Pcre2Type<8>::MatchContext *mcontext){
         return pcre2_match_8(code, subject, length, startoffset, options, match_data, mcontext);
     }
+    static int jit_match(  const Pcre2Type<8>::Pcre2Code *code,
+                            Pcre2Type<8>::Pcre2Sptr subject,
+                            PCRE2_SIZE length,
+                            PCRE2_SIZE startoffset,
+                            uint32_t options,
+                            Pcre2Type<8>::MatchData *match_data,
+                            Pcre2Type<8>::MatchContext *mcontext){
+        return pcre2_jit_match_8(code, subject, length, startoffset, options, match_data, mcontext);
+    }
     static void match_data_free(Pcre2Type<8>::MatchData *match_data){
         pcre2_match_data_free_8(match_data);
     }
@@ -353,30 +439,44 @@ template<> struct Pcre2Func<8> {
     static int set_newline(Pcre2Type<8>::CompileContext *ccontext, uint32_t value){
         return pcre2_set_newline_8(ccontext, value);
     }
-    //~ static void jit_stack_assign(Pcre2Type<8>::MatchContext *mcontext,
-                                 //~ Pcre2Type<8>::JitCallback callback_function,
-                                 //~ void *callback_data){
-        //~ pcre2_jit_stack_assign_8(mcontext, callback_function, callback_data);
-    //~ }
-    //~ static Pcre2Type<8>::JitStack *jit_stack_create(PCRE2_SIZE startsize, PCRE2_SIZE maxsize,
-                                                             //~ Pcre2Type<8>::GeneralContext *gcontext){
-    //~ return pcre2_jit_stack_create_8(startsize, maxsize, gcontext);
-    //~ }
-    //~ static void jit_stack_free(Pcre2Type<8>::JitStack *jit_stack){
-        //~ pcre2_jit_stack_free_8(jit_stack);
-    //~ }
-    //~ static void jit_free_unused_memory(Pcre2Type<8>::GeneralContext *gcontext){
-        //~ pcre2_jit_free_unused_memory_8(gcontext);
-    //~ }
-    //~ static Pcre2Type<8>::MatchContext *match_context_create(Pcre2Type<8>::GeneralContext *gcontext){
-        //~ return pcre2_match_context_create_8(gcontext);
-    //~ }
-    //~ static Pcre2Type<8>::MatchContext *match_context_copy(Pcre2Type<8>::MatchContext *mcontext){
-        //~ return pcre2_match_context_copy_8(mcontext);
-    //~ }
-    //~ static void match_context_free(Pcre2Type<8>::MatchContext *mcontext){
-        //~ pcre2_match_context_free_8(mcontext);
-    //~ }
+    static void jit_stack_assign(Pcre2Type<8>::MatchContext *mcontext,
+                                 Pcre2Type<8>::JitCallback callback_function,
+                                 void *callback_data){
+        pcre2_jit_stack_assign_8(mcontext, callback_function, callback_data);
+    }
+    static Pcre2Type<8>::JitStack *jit_stack_create(PCRE2_SIZE startsize, PCRE2_SIZE maxsize,
+                                                             Pcre2Type<8>::GeneralContext *gcontext){
+        return pcre2_jit_stack_create_8(startsize, maxsize, gcontext);
+    }
+    static void jit_stack_free(Pcre2Type<8>::JitStack *jit_stack){
+        pcre2_jit_stack_free_8(jit_stack);
+    }
+    static void jit_free_unused_memory(Pcre2Type<8>::GeneralContext *gcontext){
+        pcre2_jit_free_unused_memory_8(gcontext);
+    }
+    static Pcre2Type<8>::MatchContext *match_context_create(Pcre2Type<8>::GeneralContext *gcontext){
+        return pcre2_match_context_create_8(gcontext);
+    }
+    static Pcre2Type<8>::MatchContext *match_context_copy(Pcre2Type<8>::MatchContext *mcontext){
+        return pcre2_match_context_copy_8(mcontext);
+    }
+    static void match_context_free(Pcre2Type<8>::MatchContext *mcontext){
+        pcre2_match_context_free_8(mcontext);
+    }
+    static int set_match_limit(Pcre2Type<8>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_match_limit_8(mcontext, value);
+    }
+    static int set_depth_limit(Pcre2Type<8>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_depth_limit_8(mcontext, value);
+    }
+    static int set_heap_limit(Pcre2Type<8>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_heap_limit_8(mcontext, value);
+    }
+    static int set_callout(Pcre2Type<8>::MatchContext *mcontext,
+                           int (*callout_function)(Pcre2Type<8>::CalloutBlock *, void *),
+                           void *callout_data){
+        return pcre2_set_callout_8(mcontext, callout_function, callout_data);
+    }
     static uint32_t get_ovector_count(Pcre2Type<8>::MatchData *match_data){
         return pcre2_get_ovector_count_8(match_data);
     }
@@ -396,6 +496,18 @@ template<> struct Pcre2Func<16> {
     static const unsigned char * maketables(Pcre2Type<16>::GeneralContext* gcontext){
         return pcre2_maketables_16(gcontext);
     }
+    #ifdef JPCRE2_HAVE_MAKETABLES_FREE
+    static void maketables_free(Pcre2Type<16>::GeneralContext* gcontext, const unsigned char * tables){
+        pcre2_maketables_free_16(gcontext, tables);
+    }
+    #endif
+    static Pcre2Type<16>::GeneralContext* general_context_create(void* (*private_malloc)(PCRE2_SIZE, void*),
+                                                                  void (*private_free)(void*, void*), void* memory_data){
+        return pcre2_general_context_create_16(private_malloc, private_free, memory_data);
+    }
+    static void general_context_free(Pcre2Type<16>::GeneralContext* gcontext){
+        pcre2_general_context_free_16(gcontext);
+    }
     static int set_character_tables(Pcre2Type<16>::CompileContext * ccontext, const unsigned char * table){
         return pcre2_set_character_tables_16(ccontext, table);
     }
@@ -439,12 +551,27 @@ template<> struct Pcre2Func<16> {
     //~ static void substring_free(Pcre2Type<16>::Pcre2Uchar *buffer){
         //~ pcre2_substring_free_16(buffer);
     //~ }
-    //~ static Pcre2Type<16>::Pcre2Code * code_copy(const Pcre2Type<16>::Pcre2Code *code){
-        //~ return pcre2_code_copy_16(code);
-    //~ }
+    static Pcre2Type<16>::Pcre2Code * code_copy(const Pcre2Type<16>::Pcre2Code *code){
+        return pcre2_code_copy_16(code);
+    }
     static void code_free(Pcre2Type<16>::Pcre2Code *code){
         pcre2_code_free_16(code);
     }
+    static int32_t serialize_encode(const Pcre2Type<16>::Pcre2Code **codes, int32_t number_of_codes,
+                                    uint8_t **serialized_bytes, PCRE2_SIZE *serialized_size,
+                                    Pcre2Type<16>::GeneralContext *gcontext){
+        return pcre2_serialize_encode_16(codes, number_of_codes, serialized_bytes, serialized_size, gcontext);
+    }
+    static int32_t serialize_decode(Pcre2Type<16>::Pcre2Code **codes, int32_t number_of_codes,
+                                    const uint8_t *bytes, Pcre2Type<16>::GeneralContext *gcontext){
+        return pcre2_serialize_decode_16(codes, number_of_codes, bytes, gcontext);
+    }
+    static int32_t serialize_get_number_of_codes(const uint8_t *bytes){
+        return pcre2_serialize_get_number_of_codes_16(bytes);
+    }
+    static void serialize_free(uint8_t *bytes){
+        pcre2_serialize_free_16(bytes);
+    }
     static int get_error_message(  int errorcode,
                             Pcre2Type<16>::Pcre2Uchar *buffer,
                             PCRE2_SIZE bufflen){
@@ -465,6 +592,15 @@ template<> struct Pcre2Func<16> {
                             Pcre2Type<16>::MatchContext *mcontext){
         return pcre2_match_16(code, subject, length, startoffset, options, match_data, mcontext);
     }
+    static int jit_match(  const Pcre2Type<16>::Pcre2Code *code,
+                            Pcre2Type<16>::Pcre2Sptr subject,
+                            PCRE2_SIZE length,
+                            PCRE2_SIZE startoffset,
+                            uint32_t options,
+                            Pcre2Type<16>::MatchData *match_data,
+                            Pcre2Type<16>::MatchContext *mcontext){
+        return pcre2_jit_match_16(code, subject, length, startoffset, options, match_data, mcontext);
+    }
     static void match_data_free(Pcre2Type<16>::MatchData *match_data){
         pcre2_match_data_free_16(match_data);
     }
@@ -477,30 +613,44 @@ template<> struct Pcre2Func<16> {
     static int set_newline(Pcre2Type<16>::CompileContext *ccontext, uint32_t value){
         return pcre2_set_newline_16(ccontext, value);
     }
-    //~ static void jit_stack_assign(Pcre2Type<16>::MatchContext *mcontext,
-                                 //~ Pcre2Type<16>::JitCallback callback_function,
-                                 //~ void *callback_data){
-        //~ pcre2_jit_stack_assign_16(mcontext, callback_function, callback_data);
-    //~ }
-    //~ static Pcre2Type<16>::JitStack *jit_stack_create(PCRE2_SIZE startsize, PCRE2_SIZE maxsize,
-                                                             //~ Pcre2Type<16>::GeneralContext *gcontext){
-    //~ return pcre2_jit_stack_create_16(startsize, maxsize, gcontext);
-    //~ }
-    //~ static void jit_stack_free(Pcre2Type<16>::JitStack *jit_stack){
-        //~ pcre2_jit_stack_free_16(jit_stack);
-    //~ }
-    //~ static void jit_free_unused_memory(Pcre2Type<16>::GeneralContext *gcontext){
-        //~ pcre2_jit_free_unused_memory_16(gcontext);
-    //~ }
-    //~ static Pcre2Type<16>::MatchContext *match_context_create(Pcre2Type<16>::GeneralContext *gcontext){
-        //~ return pcre2_match_context_create_16(gcontext);
-    //~ }
-    //~ static Pcre2Type<16>::MatchContext *match_context_copy(Pcre2Type<16>::MatchContext *mcontext){
-        //~ return pcre2_match_context_copy_16(mcontext);
-    //~ }
-    //~ static void match_context_free(Pcre2Type<16>::MatchContext *mcontext){
-        //~ pcre2_match_context_free_16(mcontext);
-    //~ }
+    static void jit_stack_assign(Pcre2Type<16>::MatchContext *mcontext,
+                                 Pcre2Type<16>::JitCallback callback_function,
+                                 void *callback_data){
+        pcre2_jit_stack_assign_16(mcontext, callback_function, callback_data);
+    }
+    static Pcre2Type<16>::JitStack *jit_stack_create(PCRE2_SIZE startsize, PCRE2_SIZE maxsize,
+                                                             Pcre2Type<16>::GeneralContext *gcontext){
+        return pcre2_jit_stack_create_16(startsize, maxsize, gcontext);
+    }
+    static void jit_stack_free(Pcre2Type<16>::JitStack *jit_stack){
+        pcre2_jit_stack_free_16(jit_stack);
+    }
+    static void jit_free_unused_memory(Pcre2Type<16>::GeneralContext *gcontext){
+        pcre2_jit_free_unused_memory_16(gcontext);
+    }
+    static Pcre2Type<16>::MatchContext *match_context_create(Pcre2Type<16>::GeneralContext *gcontext){
+        return pcre2_match_context_create_16(gcontext);
+    }
+    static Pcre2Type<16>::MatchContext *match_context_copy(Pcre2Type<16>::MatchContext *mcontext){
+        return pcre2_match_context_copy_16(mcontext);
+    }
+    static void match_context_free(Pcre2Type<16>::MatchContext *mcontext){
+        pcre2_match_context_free_16(mcontext);
+    }
+    static int set_match_limit(Pcre2Type<16>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_match_limit_16(mcontext, value);
+    }
+    static int set_depth_limit(Pcre2Type<16>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_depth_limit_16(mcontext, value);
+    }
+    static int set_heap_limit(Pcre2Type<16>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_heap_limit_16(mcontext, value);
+    }
+    static int set_callout(Pcre2Type<16>::MatchContext *mcontext,
+                           int (*callout_function)(Pcre2Type<16>::CalloutBlock *, void *),
+                           void *callout_data){
+        return pcre2_set_callout_16(mcontext, callout_function, callout_data);
+    }
     static uint32_t get_ovector_count(Pcre2Type<16>::MatchData *match_data){
         return pcre2_get_ovector_count_16(match_data);
     }
@@ -520,6 +670,18 @@ template<> struct Pcre2Func<32> {
     static const unsigned char * maketables(Pcre2Type<32>::GeneralContext* gcontext){
         return pcre2_maketables_32(gcontext);
     }
+    #ifdef JPCRE2_HAVE_MAKETABLES_FREE
+    static void maketables_free(Pcre2Type<32>::GeneralContext* gcontext, const unsigned char * tables){
+        pcre2_maketables_free_32(gcontext, tables);
+    }
+    #endif
+    static Pcre2Type<32>::GeneralContext* general_context_create(void* (*private_malloc)(PCRE2_SIZE, void*),
+                                                                  void (*private_free)(void*, void*), void* memory_data){
+        return pcre2_general_context_create_32(private_malloc, private_free, memory_data);
+    }
+    static void general_context_free(Pcre2Type<32>::GeneralContext* gcontext){
+        pcre2_general_context_free_32(gcontext);
+    }
     static int set_character_tables(Pcre2Type<32>::CompileContext * ccontext, const unsigned char * table){
         return pcre2_set_character_tables_32(ccontext, table);
     }
@@ -563,12 +725,27 @@ template<> struct Pcre2Func<32> {
     //~ static void substring_free(Pcre2Type<32>::Pcre2Uchar *buffer){
         //~ pcre2_substring_free_32(buffer);
     //~ }
-    //~ static Pcre2Type<32>::Pcre2Code * code_copy(const Pcre2Type<32>::Pcre2Code *code){
-        //~ return pcre2_code_copy_32(code);
-    //~ }
+    static Pcre2Type<32>::Pcre2Code * code_copy(const Pcre2Type<32>::Pcre2Code *code){
+        return pcre2_code_copy_32(code);
+    }
     static void code_free(Pcre2Type<32>::Pcre2Code *code){
         pcre2_code_free_32(code);
     }
+    static int32_t serialize_encode(const Pcre2Type<32>::Pcre2Code **codes, int32_t number_of_codes,
+                                    uint8_t **serialized_bytes, PCRE2_SIZE *serialized_size,
+                                    Pcre2Type<32>::GeneralContext *gcontext){
+        return pcre2_serialize_encode_32(codes, number_of_codes, serialized_bytes, serialized_size, gcontext);
+    }
+    static int32_t serialize_decode(Pcre2Type<32>::Pcre2Code **codes, int32_t number_of_codes,
+                                    const uint8_t *bytes, Pcre2Type<32>::GeneralContext *gcontext){
+        return pcre2_serialize_decode_32(codes, number_of_codes, bytes, gcontext);
+    }
+    static int32_t serialize_get_number_of_codes(const uint8_t *bytes){
+        return pcre2_serialize_get_number_of_codes_32(bytes);
+    }
+    static void serialize_free(uint8_t *bytes){
+        pcre2_serialize_free_32(bytes);
+    }
     static int get_error_message(  int errorcode,
                             Pcre2Type<32>::Pcre2Uchar *buffer,
                             PCRE2_SIZE bufflen){
@@ -589,6 +766,15 @@ template<> struct Pcre2Func<32> {
                             Pcre2Type<32>::MatchContext *mcontext){
         return pcre2_match_32(code, subject, length, startoffset, options, match_data, mcontext);
     }
+    static int jit_match(  const Pcre2Type<32>::Pcre2Code *code,
+                            Pcre2Type<32>::Pcre2Sptr subject,
+                            PCRE2_SIZE length,
+                            PCRE2_SIZE startoffset,
+                            uint32_t options,
+                            Pcre2Type<32>::MatchData *match_data,
+                            Pcre2Type<32>::MatchContext *mcontext){
+        return pcre2_jit_match_32(code, subject, length, startoffset, options, match_data, mcontext);
+    }
     static void match_data_free(Pcre2Type<32>::MatchData *match_data){
         pcre2_match_data_free_32(match_data);
     }
@@ -601,35 +787,57 @@ template<> struct Pcre2Func<32> {
     static int set_newline(Pcre2Type<32>::CompileContext *ccontext, uint32_t value){
         return pcre2_set_newline_32(ccontext, value);
     }
-    //~ static void jit_stack_assign(Pcre2Type<32>::MatchContext *mcontext,
-                                 //~ Pcre2Type<32>::JitCallback callback_function,
-                                 //~ void *callback_data){
-        //~ pcre2_jit_stack_assign_32(mcontext, callback_function, callback_data);
-    //~ }
-    //~ static Pcre2Type<32>::JitStack *jit_stack_create(PCRE2_SIZE startsize, PCRE2_SIZE maxsize,
-                                                             //~ Pcre2Type<32>::GeneralContext *gcontext){
-    //~ return pcre2_jit_stack_create_32(startsize, maxsize, gcontext);
-    //~ }
-    //~ static void jit_stack_free(Pcre2Type<32>::JitStack *jit_stack){
-        //~ pcre2_jit_stack_free_32(jit_stack);
-    //~ }
-    //~ static void jit_free_unused_memory(Pcre2Type<32>::GeneralContext *gcontext){
-        //~ pcre2_jit_free_unused_memory_32(gcontext);
-    //~ }
-    //~ static Pcre2Type<32>::MatchContext *match_context_create(Pcre2Type<32>::GeneralContext *gcontext){
-        //~ return pcre2_match_context_create_32(gcontext);
-    //~ }
-    //~ static Pcre2Type<32>::MatchContext *match_context_copy(Pcre2Type<32>::MatchContext *mcontext){
-        //~ return pcre2_match_context_copy_32(mcontext);
-    //~ }
-    //~ static void match_context_free(Pcre2Type<32>::MatchContext *mcontext){
-        //~ pcre2_match_context_free_32(mcontext);
-    //~ }
+    static void jit_stack_assign(Pcre2Type<32>::MatchContext *mcontext,
+                                 Pcre2Type<32>::JitCallback callback_function,
+                                 void *callback_data){
+        pcre2_jit_stack_assign_32(mcontext, callback_function, callback_data);
+    }
+    static Pcre2Type<32>::JitStack *jit_stack_create(PCRE2_SIZE startsize, PCRE2_SIZE maxsize,
+                                                             Pcre2Type<32>::GeneralContext *gcontext){
+        return pcre2_jit_stack_create_32(startsize, maxsize, gcontext);
+    }
+    static void jit_stack_free(Pcre2Type<32>::JitStack *jit_stack){
+        pcre2_jit_stack_free_32(jit_stack);
+    }
+    static void jit_free_unused_memory(Pcre2Type<32>::GeneralContext *gcontext){
+        pcre2_jit_free_unused_memory_32(gcontext);
+    }
+    static Pcre2Type<32>::MatchContext *match_context_create(Pcre2Type<32>::GeneralContext *gcontext){
+        return pcre2_match_context_create_32(gcontext);
+    }
+    static Pcre2Type<32>::MatchContext *match_context_copy(Pcre2Type<32>::MatchContext *mcontext){
+        return pcre2_match_context_copy_32(mcontext);
+    }
+    static void match_context_free(Pcre2Type<32>::MatchContext *mcontext){
+        pcre2_match_context_free_32(mcontext);
+    }
+    static int set_match_limit(Pcre2Type<32>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_match_limit_32(mcontext, value);
+    }
+    static int set_depth_limit(Pcre2Type<32>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_depth_limit_32(mcontext, value);
+    }
+    static int set_heap_limit(Pcre2Type<32>::MatchContext *mcontext, uint32_t value){
+        return pcre2_set_heap_limit_32(mcontext, value);
+    }
+    static int set_callout(Pcre2Type<32>::MatchContext *mcontext,
+                           int (*callout_function)(Pcre2Type<32>::CalloutBlock *, void *),
+                           void *callout_data){
+        return pcre2_set_callout_32(mcontext, callout_function, callout_data);
+    }
     static uint32_t get_ovector_count(Pcre2Type<32>::MatchData *match_data){
         return pcre2_get_ovector_count_32(match_data);
     }
 };
 
+//The general context set with select::setGeneralContext(), one for each code unit width.
+template<Ush BS> struct GeneralContextOf {
+    static typename Pcre2Type<BS>::GeneralContext*& get(){
+        static typename Pcre2Type<BS>::GeneralContext* gcontext = 0;
+        return gcontext;
+    }
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -832,6 +1040,67 @@ namespace MOD {
 
 } //MOD namespace ends
 
+///Appends data to a byte vector in native byte order.
+///Used to serialize compiled patterns (see select::Regex::serialize()).
+struct ByteWriter {
+    std::vector<unsigned char>* bytes; ///< Where to write.
+    ///Append n bytes from p.
+    void put(void const* p, SIZE_T n){
+        unsigned char const* b = (unsigned char const*) p;
+        bytes->insert(bytes->end(), b, b + n);
+    }
+    ///Append an option value.
+    void putUint(Uint x){ put(&x, sizeof(x)); }
+    ///Append a size.
+    void putSize(SIZE_T x){ put(&x, sizeof(x)); }
+    ///Append a string with its length.
+    template<typename C>
+    void putString(std::basic_string<C> const& s){
+        putSize(s.size());
+        put(s.data(), s.size() * sizeof(C));
+    }
+    ///Append an option vector with its size.
+    void putVecOpt(VecOpt const& v){
+        putSize(v.size());
+        if(!v.empty()) put(&v[0], v.size() * sizeof(Uint));
+    }
+};
+
+///Reads data written with ByteWriter.
+///Every getter returns false (leaving the output unchanged) if there's not enough data.
+struct ByteReader {
+    unsigned char const* p;     ///< Current position.
+    unsigned char const* end;   ///< End of data.
+    ///Number of bytes left.
+    SIZE_T left() const { return (SIZE_T) (end - p); }
+    ///Read n bytes into d.
+    bool get(void* d, SIZE_T n){
+        if(left() < n) return false;
+        if(n) std::char_traits<char>::copy((char*) d, (char const*) p, n);
+        p += n;
+        return true;
+    }
+    ///Read an option value.
+    bool getUint(Uint& x){ return get(&x, sizeof(x)); }
+    ///Read a size.
+    bool getSize(SIZE_T& x){ return get(&x, sizeof(x)); }
+    ///Read a string.
+    template<typename C>
+    bool getString(std::basic_string<C>& s){
+        SIZE_T n;
+        if(!getSize(n) || n > left() / sizeof(C)) return false;
+        s.resize(n);
+        return n == 0 || get(&s[0], n * sizeof(C));
+    }
+    ///Read an option vector.
+    bool getVecOpt(VecOpt& v){
+        SIZE_T n;
+        if(!getSize(n) || n > left() / sizeof(Uint)) return false;
+        v.resize(n);
+        return n == 0 || get(&v[0], n * sizeof(Uint));
+    }
+};
+
 ///Lets you create custom modifier tables.
 ///An instance of this class can be passed to
 ///match, replace or compile related class objects.
@@ -974,6 +1243,29 @@ class ModifierTable{
         return *this;
     }
 
+    ///Write the tables (used by select::Regex::serialize()).
+    ///@param out ByteWriter to write to.
+    void serialize(ByteWriter& out) const {
+        std::string const* s[] = {&tabjms, &tabms, &tabjrs, &tabrs, &tabjcs, &tabcs};
+        VecOpt const* v[] = {&tabjmv, &tabmv, &tabjrv, &tabrv, &tabjcv, &tabcv};
+        for(int i = 0; i < 6; ++i){
+            out.putString(*s[i]);
+            out.putVecOpt(*v[i]);
+        }
+    }
+
+    ///Read the tables written by serialize() (used by select::Regex::deserialize()).
+    ///@param in ByteReader to read from.
+    ///@return false if the data is not valid.
+    bool deserialize(ByteReader& in){
+        std::string* s[] = {&tabjms, &tabms, &tabjrs, &tabrs, &tabjcs, &tabcs};
+        VecOpt* v[] = {&tabjmv, &tabmv, &tabjrv, &tabrv, &tabjcv, &tabcv};
+        for(int i = 0; i < 6; ++i){
+            if(!in.getString(*s[i]) || !in.getVecOpt(*v[i]) || s[i]->size() != v[i]->size()) return false;
+        }
+        return true;
+    }
+
     ///Modifier parser for match related options.
     ///@param mod modifier string
     ///@param x whether to add or remove the modifers.
@@ -1192,130 +1484,1004 @@ class ModifierTable{
 };
 
 
-//These message strings are used for error/warning message construction.
-//take care to prevent multiple definition
-template<typename Char_T> struct MSG{
-    static std::basic_string<Char_T> INVALID_MODIFIER(void);
-    static std::basic_string<Char_T> INSUFFICIENT_OVECTOR(void);
-};
-//specialization
-template<> inline std::basic_string<char> MSG<char>::INVALID_MODIFIER(){ return "Invalid modifier: "; }
-template<> inline std::basic_string<wchar_t> MSG<wchar_t>::INVALID_MODIFIER(){ return L"Invalid modifier: "; }
-template<> inline std::basic_string<char> MSG<char>::INSUFFICIENT_OVECTOR(){ return "ovector wasn't big enough"; }
-template<> inline std::basic_string<wchar_t> MSG<wchar_t>::INSUFFICIENT_OVECTOR(){ return L"ovector wasn't big enough"; }
-#ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<> inline std::basic_string<char16_t> MSG<char16_t>::INVALID_MODIFIER(){ return u"Invalid modifier: "; }
-template<> inline std::basic_string<char32_t> MSG<char32_t>::INVALID_MODIFIER(){ return U"Invalid modifier: "; }
-template<> inline std::basic_string<char16_t> MSG<char16_t>::INSUFFICIENT_OVECTOR(){ return u"ovector wasn't big enough"; }
-template<> inline std::basic_string<char32_t> MSG<char32_t>::INSUFFICIENT_OVECTOR(){ return U"ovector wasn't big enough"; }
-#endif
-
-///struct to select the types.
-///
-///@tparam Char_T Character type (`char`, `wchar_t`, `char16_t`, `char32_t`)
-///@tparam Map Optional parameter (Only `>= C++11`) to specify a map container (`std::map`, `std::unordered_map` etc..). Default is `std::map`.
-///
-///The character type (`Char_T`) must be in accordance with the PCRE2 library you are linking against.
-///If not sure which library you need, link against all 3 PCRE2 libraries and they will be used as needed.
-///
-///If you want to be specific, then here's the rule:
-///
-///1. If `Char_T` is 8 bit, you need 8 bit PCRE2 library
-///2. If `Char_T` is 16 bit, you need 16 bit PCRE2 library
-///3. If `Char_T` is 32 bit, you need 32 bit PCRE2 library
-///4. if `Char_T` is not 8 or 16 or 32 bit, you will get compile error.
+#ifdef JPCRE2_USE_THREADS
+///A fixed size pool of worker threads.
 ///
-///In `>= C++11` you get an additional optional template parameter to specify a map container.
-///For example, you can use `std::unordered_map` instead of the default `std::map`:
-/// ```cpp
-/// #include <unordered_map>
-/// typedef jpcre2::select<char, std::unordered_map> jp;
-/// ```
+///A pool can be attached to jpcre2::select::RegexMatch and jpcre2::select::RegexReplace objects
+///(see `setThreadPool()`) to split a global match or replace on a very large subject into chunks
+///that are searched concurrently. The same pool can be shared by any number of objects and threads.
+///The pool is not owned by the objects it is attached to; it must outlive them.
 ///
-///We will use the following typedef throughout this doc:
-///```cpp
-///typedef jpcre2::select<Char_T> jp;
-///```
-#ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map=std::map>
-#else
-template<typename Char_T>
-#endif
-struct select{
-
-    ///Typedef for character (`char`, `wchar_t`, `char16_t`, `char32_t`)
-    typedef Char_T Char;
-
-    //typedef Char_T Char;
-    ///Typedef for string (`std::string`, `std::wstring`, `std::u16string`, `std::u32string`).
-    ///Defined as `std::basic_string<Char_T>`.
-    ///May be this list will make more sense:
-    ///Character  | String
-    ///---------  | -------
-    ///char | std::string
-    ///wchar_t | std::wstring
-    ///char16_t | std::u16string (>=C++11)
-    ///char32_t | std::u32string (>=C++11)
-    typedef typename std::basic_string<Char_T> String;
+///Threads are created once in the constructor and joined in the destructor.
+///Not available if `JPCRE2_DISABLE_THREADS` is defined or `< C++11` is used.
+class ThreadPool{
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping;
+
+    void work(){
+        for(;;){
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this]{ return stopping || !tasks.empty(); });
+                if(tasks.empty()) return; //stopping and nothing left to do
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
 
-    #ifdef JPCRE2_USE_MINIMUM_CXX_11
-    ///Map for Named substrings.
-    typedef class Map<String, String> MapNas;
-    ///Substring name to Substring number map.
-    typedef class Map<String, SIZE_T> MapNtN;
-    #else
-    ///Map for Named substrings.
-    typedef typename std::map<String, String> MapNas;
-    ///Substring name to Substring number map.
-    typedef typename std::map<String, SIZE_T> MapNtN;
-    #endif
+    ThreadPool(ThreadPool const&);
+    ThreadPool& operator=(ThreadPool const&);
 
-    ///Allow spelling mistake of MapNtN as MapNtn.
-    typedef MapNtN MapNtn;
+    public:
 
-    ///Vector for Numbered substrings (Sub container).
-    #ifdef JPCRE2_UNSET_CAPTURES_NULL
-    typedef typename std::vector<std::optional<String>> NumSub;
-    #else
-    typedef typename std::vector<String> NumSub;
-    #endif
-    ///Vector of matches with named substrings.
-    typedef typename std::vector<MapNas> VecNas;
-    ///Vector of substring name to substring number map.
-    typedef typename std::vector<MapNtN> VecNtN;
-    ///Allow spelling mistake of VecNtN as VecNtn.
-    typedef VecNtN VecNtn;
-    ///Vector of matches with numbered substrings.
-    typedef typename std::vector<NumSub> VecNum;
+    ///Constructor.
+    ///@param n Number of worker threads. 0 (default) means `std::thread::hardware_concurrency()`.
+    explicit ThreadPool(SIZE_T n = 0):stopping(false){
+        if(n == 0) n = std::thread::hardware_concurrency();
+        if(n == 0) n = 2;
+        workers.reserve(n);
+        for(SIZE_T i = 0; i < n; ++i) workers.push_back(std::thread(&ThreadPool::work, this));
+    }
 
-    //These are to shorten the code
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::Pcre2Uchar Pcre2Uchar;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::Pcre2Sptr Pcre2Sptr;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::Pcre2Code Pcre2Code;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::CompileContext CompileContext;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::MatchData MatchData;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::GeneralContext GeneralContext;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::MatchContext MatchContext;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::JitCallback JitCallback;
-    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::JitStack JitStack;
+    ///Destructor.
+    ///Finishes the tasks that are already posted and joins the worker threads.
+    ~ThreadPool(){
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for(SIZE_T i = 0; i < workers.size(); ++i) workers[i].join();
+    }
 
-    template<typename T>
-    static String toString(T); //prevent implicit type conversion of T
+    ///Get the number of worker threads.
+    ///@return number of worker threads.
+    SIZE_T size() const { return workers.size(); }
 
-    ///Converts a Char_T to jpcre2::select::String
-    ///@param a Char_T
-    ///@return jpcre2::select::String
-    static String toString(Char a){
-        return a?String(1, a):String();
+    ///Post a task to be run by one of the worker threads.
+    ///The task must not throw.
+    ///@param task A callable taking no argument.
+    void post(std::function<void()> task){
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
     }
 
-    ///@overload
-    ///...
-    ///Converts a Char_T const * to jpcre2::select::String
-    ///@param a Char_T const *
-    ///@return jpcre2::select::String
-    static String toString(Char const *a){
-        return a?String(a):String();
+    ///Call `fn(i)` for each `i` in `[0, n)` and wait for all of them to finish.
+    ///
+    ///The calling thread takes part in the work, thus it is safe to call this function
+    ///from inside a task that is running on the same pool.
+    ///If any of the calls throws, the first exception is rethrown after all calls have finished.
+    ///@param n Number of calls.
+    ///@param fn A callable taking a jpcre2::SIZE_T.
+    template<typename Fn>
+    void parallelFor(SIZE_T n, Fn const& fn){
+        if(n == 0) return;
+        struct State{
+            std::atomic<SIZE_T> next;
+            SIZE_T done;
+            std::exception_ptr err;
+            std::mutex m;
+            std::condition_variable cv;
+            State():next(0), done(0){}
+        };
+        std::shared_ptr<State> st = std::make_shared<State>();
+        Fn const* f = &fn;
+        std::function<void()> run = [st, f, n]{
+            for(SIZE_T i; (i = st->next++) < n; ){
+                std::exception_ptr err;
+                try{ (*f)(i); } catch(...){ err = std::current_exception(); }
+                std::lock_guard<std::mutex> lock(st->m);
+                if(err && !st->err) st->err = err;
+                if(++st->done == n) st->cv.notify_all();
+            }
+        };
+        SIZE_T helpers = n - 1 < workers.size() ? n - 1 : workers.size();
+        for(SIZE_T i = 0; i < helpers; ++i) post(run);
+        run();
+        std::unique_lock<std::mutex> lock(st->m);
+        st->cv.wait(lock, [&st, n]{ return st->done == n; });
+        if(st->err) std::rethrow_exception(st->err);
+    }
+};
+#endif
+
+#ifndef JPCRE2_USE_MINIMUM_CXX_11
+//The part of std::atomic used for the values shared by threads (reference counts, ids...) before C++11.
+//It uses the __atomic builtins of GCC and the compilers that have them (e.g Clang), otherwise it is not MT safe.
+template<typename T>
+class Atomic {
+    T v;
+    public:
+    Atomic(T x = T()):v(x){}
+    #ifdef __ATOMIC_SEQ_CST
+    operator T() const { return __atomic_load_n(&v, __ATOMIC_SEQ_CST); }
+    Atomic& operator=(T x){ __atomic_store_n(&v, x, __ATOMIC_SEQ_CST); return *this; }
+    T exchange(T x){ return __atomic_exchange_n(&v, x, __ATOMIC_SEQ_CST); }
+    T operator++(){ return __atomic_add_fetch(&v, 1, __ATOMIC_SEQ_CST); }
+    T operator--(){ return __atomic_sub_fetch(&v, 1, __ATOMIC_SEQ_CST); }
+    #else
+    operator T() const { return v; }
+    Atomic& operator=(T x){ v = x; return *this; }
+    T exchange(T x){ T r = v; v = x; return r; }
+    T operator++(){ return ++v; }
+    T operator--(){ return --v; }
+    #endif
+};
+#endif
+
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+///A flag to stop matches and replaces from another thread.
+///
+///Attach it to jpcre2::select::RegexMatch, jpcre2::select::RegexReplace or jpcre2::select::MatchEvaluator
+///objects (see `setCancelToken()`) and call cancel() from any thread: the operations that use it stop
+///at their next check with the error `jpcre2::ERROR::CANCELLED`, keeping what they have done so far.
+///The token is not owned by the objects it is attached to; it must outlive them.
+///Only available with `>= C++11`.
+class CancelToken{
+    std::atomic<bool> cancelled;
+
+    CancelToken(CancelToken const&); //not copyable
+    CancelToken& operator=(CancelToken const&);
+
+    public:
+
+    CancelToken():cancelled(false){}
+
+    ///Request the operations that use this token to stop.
+    void cancel(){
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    ///Clear the request, to use the token again.
+    void reset(){
+        cancelled.store(false, std::memory_order_relaxed);
+    }
+
+    ///Check whether cancel() has been called.
+    ///@return true if cancelled.
+    bool isCancelled() const {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+};
+#endif
+
+
+///A monotonic memory arena: memory is taken from a few big blocks and freed all at once.
+///
+///Used by jpcre2::select::RegexMatch to hold captured substrings (see jpcre2::select::ArenaVecNum), through
+///jpcre2::ArenaAllocator, but it can be used on its own as well. Freeing single allocations is a no-op;
+///reset() makes all the memory available again in one go. It's not thread safe.
+class Arena{
+    struct Block {
+        Block* next;
+        SIZE_T size; //including this header
+    };
+
+    Block* head; //the block being used, the others follow it
+    char* cur;
+    char* end;
+    SIZE_T block_size;
+    SIZE_T memory; //size of all blocks
+
+    Arena(Arena const&); //not copyable
+    Arena& operator=(Arena const&);
+
+    void newBlock(SIZE_T n){
+        SIZE_T size = sizeof(Block) + n;
+        if(size < block_size) size = block_size;
+        Block* b = static_cast<Block*>(::operator new(size));
+        b->next = head;
+        b->size = size;
+        head = b;
+        memory += size;
+        cur = reinterpret_cast<char*>(b + 1);
+        end = reinterpret_cast<char*>(b) + size;
+    }
+
+    public:
+
+    ///Constructor.
+    ///No memory is taken until the first allocation.
+    ///@param bsize Size of the blocks, defaults to `JPCRE2_DEFAULT_ARENA_BLOCK_SIZE`
+    ///(bigger allocations get a block of their own).
+    explicit Arena(SIZE_T bsize = JPCRE2_DEFAULT_ARENA_BLOCK_SIZE)
+        :head(0), cur(0), end(0), block_size(bsize), memory(0){}
+
+    ///Destructor.
+    ~Arena(){
+        release();
+    }
+
+    ///Allocate memory.
+    ///@param n Size in bytes.
+    ///@param align Alignment, a power of 2.
+    ///@return Pointer to the memory, valid until reset(), release() or destruction of the arena.
+    void* allocate(SIZE_T n, SIZE_T align){
+        SIZE_T p = (reinterpret_cast<SIZE_T>(cur) + align - 1) & ~(align - 1);
+        if(!head || p + n > reinterpret_cast<SIZE_T>(end)){
+            newBlock(n + align);
+            p = (reinterpret_cast<SIZE_T>(cur) + align - 1) & ~(align - 1);
+        }
+        cur = reinterpret_cast<char*>(p + n);
+        return reinterpret_cast<void*>(p);
+    }
+
+    ///Make all memory available again.
+    ///Everything allocated from the arena is invalid afterwards. If more than one block has been used,
+    ///they are replaced by a single block of their total size (made on the next allocation),
+    ///thus the arena settles on one block.
+    void reset(){
+        if(head && head->next){
+            SIZE_T total = memory;
+            release();
+            if(total > block_size) block_size = total;
+        } else if(head) {
+            cur = reinterpret_cast<char*>(head + 1);
+        }
+    }
+
+    ///Free all memory.
+    void release(){
+        while(head){
+            Block* next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+        cur = end = 0;
+        memory = 0;
+    }
+
+    ///Get the memory held by the arena.
+    ///@return Size of all blocks in bytes.
+    SIZE_T getMemory() const {
+        return memory;
+    }
+};
+
+//Alignment of T without alignof (C++98)
+template<typename T> struct AlignOf {
+    struct S { char c; T t; };
+    static const SIZE_T value = sizeof(S) - sizeof(T);
+};
+
+///Standard allocator taking memory from a jpcre2::Arena.
+///
+///Deallocation is a no-op, the memory is freed with the arena. A default constructed allocator
+///(without an arena) uses `operator new` and `operator delete`, thus containers of the arena types
+///(e.g jpcre2::select::ArenaVecNum) can be declared as usual: the elements that RegexMatch puts in them
+///use its arena.
+template<typename T> class ArenaAllocator {
+    public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef T const* const_pointer;
+    typedef T& reference;
+    typedef T const& const_reference;
+    typedef SIZE_T size_type;
+    typedef std::ptrdiff_t difference_type;
+    template<typename U> struct rebind { typedef ArenaAllocator<U> other; };
+
+    Arena* arena; ///< The arena, null for `operator new`.
+
+    ///Default constructor, without an arena.
+    ArenaAllocator():arena(0){}
+    ///Constructor.
+    ///@param a Pointer to an arena, it must outlive the memory taken from it.
+    ArenaAllocator(Arena* a):arena(a){}
+    ///Converting constructor.
+    template<typename U> ArenaAllocator(ArenaAllocator<U> const& a):arena(a.arena){}
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    pointer allocate(size_type n, void const* = 0){
+        if(!arena) return static_cast<pointer>(::operator new(n * sizeof(T)));
+        return static_cast<pointer>(arena->allocate(n * sizeof(T), AlignOf<T>::value));
+    }
+
+    void deallocate(pointer p, size_type){
+        if(!arena) ::operator delete(p);
+    }
+
+    size_type max_size() const {
+        return ((size_type) -1) / sizeof(T);
+    }
+
+    void construct(pointer p, const_reference v){
+        new((void*) p) T(v);
+    }
+
+    void destroy(pointer p){
+        p->~T();
+    }
+
+    template<typename U> bool operator==(ArenaAllocator<U> const& a) const { return arena == a.arena; }
+    template<typename U> bool operator!=(ArenaAllocator<U> const& a) const { return arena != a.arena; }
+};
+
+
+///A map that keeps its elements sorted in one vector.
+///It has the interface of `std::map` used for named substrings (`[]`, `find()`, `count()`, `at()`,
+///iteration in key order, ...), but building and looking up a map of a few names doesn't allocate a
+///node for each of them. Inserting and erasing is linear, it's meant for small maps.
+///Use it for MapNas and MapNtN with `jpcre2::select<Char_T, jpcre2::FlatMap>` (>=C++11)
+///or by defining JPCRE2_USE_FLAT_MAP.
+///
+///Elements are `std::pair<Key, T>` (the key isn't const), don't change the key through an iterator.
+///Iterators and references are invalidated by insertion and erasure.
+template<typename Key, typename T, typename Compare = std::less<Key>,
+         typename Alloc = std::allocator<std::pair<Key, T> > >
+class FlatMap {
+    public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<Key, T> value_type;
+    typedef Compare key_compare;
+    typedef Alloc allocator_type;
+
+    private:
+    typedef std::vector<value_type, Alloc> Vec;
+
+    //Compares an element with a key.
+    struct KeyLess {
+        Compare comp;
+        KeyLess(Compare const& c):comp(c){}
+        bool operator()(value_type const& x, Key const& k) const { return comp(x.first, k); }
+    };
+
+    Vec v;
+    Compare comp;
+
+    public:
+    typedef typename Vec::size_type size_type;
+    typedef typename Vec::difference_type difference_type;
+    typedef typename Vec::reference reference;
+    typedef typename Vec::const_reference const_reference;
+    typedef typename Vec::iterator iterator;
+    typedef typename Vec::const_iterator const_iterator;
+    typedef typename Vec::reverse_iterator reverse_iterator;
+    typedef typename Vec::const_reverse_iterator const_reverse_iterator;
+
+    ///Default constructor.
+    FlatMap():v(), comp(){}
+    ///@overload
+    ///@param c Comparison object.
+    ///@param a Allocator.
+    explicit FlatMap(Compare const& c, Alloc const& a = Alloc()):v(a), comp(c){}
+    ///@overload
+    ///@param a Allocator.
+    explicit FlatMap(Alloc const& a):v(a), comp(){}
+    ///@overload
+    ///Inserts the elements in [first, last).
+    template<typename It> FlatMap(It first, It last):v(), comp(){ insert(first, last); }
+
+    iterator begin(){ return v.begin(); }
+    const_iterator begin() const { return v.begin(); }
+    iterator end(){ return v.end(); }
+    const_iterator end() const { return v.end(); }
+    reverse_iterator rbegin(){ return v.rbegin(); }
+    const_reverse_iterator rbegin() const { return v.rbegin(); }
+    reverse_iterator rend(){ return v.rend(); }
+    const_reverse_iterator rend() const { return v.rend(); }
+
+    bool empty() const { return v.empty(); }
+    size_type size() const { return v.size(); }
+    size_type max_size() const { return v.max_size(); }
+    ///Reserve space for n elements.
+    void reserve(size_type n){ v.reserve(n); }
+    size_type capacity() const { return v.capacity(); }
+    ///Remove all elements, the memory is kept.
+    void clear(){ v.clear(); }
+    void swap(FlatMap& m){ v.swap(m.v); std::swap(comp, m.comp); }
+    allocator_type get_allocator() const { return v.get_allocator(); }
+    key_compare key_comp() const { return comp; }
+
+    ///Get the first element whose key isn't less than k.
+    iterator lower_bound(Key const& k){ return std::lower_bound(v.begin(), v.end(), k, KeyLess(comp)); }
+    const_iterator lower_bound(Key const& k) const { return std::lower_bound(v.begin(), v.end(), k, KeyLess(comp)); }
+
+    ///Get the element with key k, end() if there's none.
+    iterator find(Key const& k){
+        iterator it = lower_bound(k);
+        return (it != v.end() && !comp(k, it->first)) ? it : v.end();
+    }
+    const_iterator find(Key const& k) const {
+        const_iterator it = lower_bound(k);
+        return (it != v.end() && !comp(k, it->first)) ? it : v.end();
+    }
+    ///Get the number of elements with key k (0 or 1).
+    size_type count(Key const& k) const { return find(k) != v.end() ? 1 : 0; }
+
+    ///Get the value of key k, it's inserted (value initialized) if it isn't there.
+    ///Keys inserted in order are appended without a search.
+    T& operator[](Key const& k){
+        if(v.empty() || comp(v.back().first, k)) {
+            v.push_back(value_type(k, T()));
+            return v.back().second;
+        }
+        iterator it = lower_bound(k);
+        if(comp(k, it->first)) it = v.insert(it, value_type(k, T()));
+        return it->second;
+    }
+
+    ///Get the value of key k.
+    ///@throw std::out_of_range if there's no such key.
+    T& at(Key const& k){
+        iterator it = find(k);
+        if(it == v.end()) throw std::out_of_range("jpcre2::FlatMap::at");
+        return it->second;
+    }
+    T const& at(Key const& k) const {
+        const_iterator it = find(k);
+        if(it == v.end()) throw std::out_of_range("jpcre2::FlatMap::at");
+        return it->second;
+    }
+
+    ///Insert x if its key isn't there.
+    ///@return The element with the key and whether x was inserted.
+    std::pair<iterator, bool> insert(value_type const& x){
+        iterator it = lower_bound(x.first);
+        if(it != v.end() && !comp(x.first, it->first)) return std::make_pair(it, false);
+        return std::make_pair(v.insert(it, x), true);
+    }
+    ///@overload
+    template<typename It> void insert(It first, It last){
+        for(; first != last; ++first) insert(*first);
+    }
+
+    ///Erase the element with key k.
+    ///@return Number of elements erased (0 or 1).
+    size_type erase(Key const& k){
+        iterator it = find(k);
+        if(it == v.end()) return 0;
+        v.erase(it);
+        return 1;
+    }
+    ///@overload
+    iterator erase(iterator it){ return v.erase(it); }
+
+    friend bool operator==(FlatMap const& a, FlatMap const& b){ return a.v == b.v; }
+    friend bool operator!=(FlatMap const& a, FlatMap const& b){ return a.v != b.v; }
+    friend bool operator<(FlatMap const& a, FlatMap const& b){ return a.v < b.v; }
+};
+
+
+/// @namespace jpcre2::PARSE
+/// Namespace for the results of jpcre2::parse().
+namespace PARSE {
+    /** Results of the conversion of a substring to a value.
+     */
+    enum {
+        OK              = 0,  ///< The value was converted
+        UNSET           = 1,  ///< The group is unset or doesn't exist
+        INVALID         = 2,  ///< The substring is not a value of the type
+        OUT_OF_RANGE    = 3   ///< The value doesn't fit in the type
+    };
+}
+
+//Integers: an optional '-' (signed types only) and decimal digits, nothing else.
+template<typename Char_T, typename T>
+int parseInteger(Char_T const* first, Char_T const* last, T& v){
+    bool neg = first != last && *first == Char_T('-');
+    if(neg && !std::numeric_limits<T>::is_signed) return PARSE::INVALID;
+    if(neg) ++first;
+    if(first == last) return PARSE::INVALID;
+    T const lim = neg ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    T r = 0;
+    bool range = true;
+    for(; first != last; ++first){
+        if(*first < Char_T('0') || *first > Char_T('9')) return PARSE::INVALID;
+        T d = (T) (*first - Char_T('0'));
+        if(!range) continue;
+        if(neg){ //accumulated as a negative number, -min may not fit
+            if(r < (lim + d) / 10) range = false;
+            else r = (T) (r * 10 - d);
+        } else {
+            if(r > (lim - d) / 10) range = false;
+            else r = (T) (r * 10 + d);
+        }
+    }
+    if(!range) return PARSE::OUT_OF_RANGE;
+    v = r;
+    return PARSE::OK;
+}
+
+inline double strToFloating(char const* s, char** end, double*){ return std::strtod(s, end); }
+inline float strToFloating(char const* s, char** end, float*){
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    return std::strtof(s, end);
+    #else
+    double d = std::strtod(s, end);
+    if(d - d == 0 && (d > std::numeric_limits<float>::max() || d < -std::numeric_limits<float>::max())) errno = ERANGE;
+    return (float) d;
+    #endif
+}
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+inline long double strToFloating(char const* s, char** end, long double*){ return std::strtold(s, end); }
+#endif
+
+//Floating point: the forms of std::strtod() without leading space, '+' and hexadecimal, copied to the stack.
+template<typename Char_T, typename T>
+int parseFloating(Char_T const* first, Char_T const* last, T& v){
+    char buf[128];
+    SIZE_T n = (SIZE_T) (last - first);
+    if(n == 0 || n >= sizeof(buf)) return PARSE::INVALID;
+    for(SIZE_T i = 0; i < n; ++i){
+        Char_T c = first[i];
+        if(c <= Char_T(' ') || c > Char_T('~') || c == Char_T('x') || c == Char_T('X') || (i == 0 && c == Char_T('+')))
+            return PARSE::INVALID;
+        buf[i] = (char) c;
+    }
+    buf[n] = 0;
+    char* end;
+    int saved = errno;
+    errno = 0;
+    T r = strToFloating(buf, &end, (T*) 0);
+    bool range = errno != ERANGE;
+    errno = saved;
+    if(end != buf + n) return PARSE::INVALID;
+    if(!range) return PARSE::OUT_OF_RANGE;
+    v = r;
+    return PARSE::OK;
+}
+
+///Convert a substring to an integer without making a string, like `std::from_chars()`.
+///
+///The whole range must be an optional `-` (signed types only) followed by decimal digits.
+///It works on any character type, for example on the subject of a match at the offsets of a group
+///(see jpcre2::select::MatchTable::parse()).
+///@param first Start of the substring.
+///@param last End of the substring.
+///@param v Where the value is stored, unchanged on error.
+///@return jpcre2::PARSE::OK, jpcre2::PARSE::INVALID or jpcre2::PARSE::OUT_OF_RANGE.
+template<typename Char_T, typename T>
+typename EnableIf<std::numeric_limits<T>::is_integer && !IsSame<T, bool>::value, int>::Type
+parse(Char_T const* first, Char_T const* last, T& v){
+    return parseInteger(first, last, v);
+}
+
+///@overload
+///...
+///Floating point types (`long double` needs `>= C++11`) take the decimal forms of `std::strtod()`, and
+///`inf` and `nan`. Leading space, `+` and hexadecimal are not accepted. The decimal point is the one of
+///the C locale (`LC_NUMERIC`). Substrings of 128 code units or more are invalid; no memory is allocated.
+template<typename Char_T, typename T>
+typename EnableIf<std::numeric_limits<T>::is_specialized && !std::numeric_limits<T>::is_integer, int>::Type
+parse(Char_T const* first, Char_T const* last, T& v){
+    return parseFloating(first, last, v);
+}
+
+///@overload
+///...
+///Strings take the substring as it is, their memory is reused.
+template<typename Char_T, typename Traits, typename Alloc>
+int parse(Char_T const* first, Char_T const* last, std::basic_string<Char_T, Traits, Alloc>& v){
+    v.assign(first, last);
+    return PARSE::OK;
+}
+
+
+//These message strings are used for error/warning message construction.
+//take care to prevent multiple definition
+template<typename Char_T> struct MSG{
+    static std::basic_string<Char_T> INVALID_MODIFIER(void);
+    static std::basic_string<Char_T> INSUFFICIENT_OVECTOR(void);
+    static std::basic_string<Char_T> FILE_IO(void);
+    static std::basic_string<Char_T> TIMEOUT(void);
+    static std::basic_string<Char_T> CANCELLED(void);
+};
+//specialization
+template<> inline std::basic_string<char> MSG<char>::INVALID_MODIFIER(){ return "Invalid modifier: "; }
+template<> inline std::basic_string<wchar_t> MSG<wchar_t>::INVALID_MODIFIER(){ return L"Invalid modifier: "; }
+template<> inline std::basic_string<char> MSG<char>::INSUFFICIENT_OVECTOR(){ return "ovector wasn't big enough"; }
+template<> inline std::basic_string<wchar_t> MSG<wchar_t>::INSUFFICIENT_OVECTOR(){ return L"ovector wasn't big enough"; }
+template<> inline std::basic_string<char> MSG<char>::FILE_IO(){ return "file could not be read or written"; }
+template<> inline std::basic_string<wchar_t> MSG<wchar_t>::FILE_IO(){ return L"file could not be read or written"; }
+template<> inline std::basic_string<char> MSG<char>::TIMEOUT(){ return "deadline exceeded"; }
+template<> inline std::basic_string<wchar_t> MSG<wchar_t>::TIMEOUT(){ return L"deadline exceeded"; }
+template<> inline std::basic_string<char> MSG<char>::CANCELLED(){ return "cancelled"; }
+template<> inline std::basic_string<wchar_t> MSG<wchar_t>::CANCELLED(){ return L"cancelled"; }
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<> inline std::basic_string<char16_t> MSG<char16_t>::INVALID_MODIFIER(){ return u"Invalid modifier: "; }
+template<> inline std::basic_string<char32_t> MSG<char32_t>::INVALID_MODIFIER(){ return U"Invalid modifier: "; }
+template<> inline std::basic_string<char16_t> MSG<char16_t>::INSUFFICIENT_OVECTOR(){ return u"ovector wasn't big enough"; }
+template<> inline std::basic_string<char32_t> MSG<char32_t>::INSUFFICIENT_OVECTOR(){ return U"ovector wasn't big enough"; }
+template<> inline std::basic_string<char16_t> MSG<char16_t>::FILE_IO(){ return u"file could not be read or written"; }
+template<> inline std::basic_string<char32_t> MSG<char32_t>::FILE_IO(){ return U"file could not be read or written"; }
+template<> inline std::basic_string<char16_t> MSG<char16_t>::TIMEOUT(){ return u"deadline exceeded"; }
+template<> inline std::basic_string<char32_t> MSG<char32_t>::TIMEOUT(){ return U"deadline exceeded"; }
+template<> inline std::basic_string<char16_t> MSG<char16_t>::CANCELLED(){ return u"cancelled"; }
+template<> inline std::basic_string<char32_t> MSG<char32_t>::CANCELLED(){ return U"cancelled"; }
+#endif
+
+///struct to select the types.
+///
+///@tparam Char_T Character type (`char`, `wchar_t`, `char16_t`, `char32_t`)
+///@tparam Map Optional parameter (Only `>= C++11`) to specify a map container (`std::map`, `std::unordered_map` etc..). Default is `std::map`.
+///
+///The character type (`Char_T`) must be in accordance with the PCRE2 library you are linking against.
+///If not sure which library you need, link against all 3 PCRE2 libraries and they will be used as needed.
+///
+///If you want to be specific, then here's the rule:
+///
+///1. If `Char_T` is 8 bit, you need 8 bit PCRE2 library
+///2. If `Char_T` is 16 bit, you need 16 bit PCRE2 library
+///3. If `Char_T` is 32 bit, you need 32 bit PCRE2 library
+///4. if `Char_T` is not 8 or 16 or 32 bit, you will get compile error.
+///
+///In `>= C++11` you get an additional optional template parameter to specify a map container.
+///For example, you can use `std::unordered_map` instead of the default `std::map`:
+/// ```cpp
+/// #include <unordered_map>
+/// typedef jpcre2::select<char, std::unordered_map> jp;
+/// ```
+///
+///The third one (also `>= C++11`) is the allocator of the strings, it's rebound for the vectors.
+///The map takes its own allocator, so pass one that matches, e.g with `std::pmr`
+///(see jpcre2::pmr::select):
+/// ```cpp
+/// typedef jpcre2::select<char, std::pmr::map, std::pmr::polymorphic_allocator<char>> jp;
+/// ```
+///
+///We will use the following typedef throughout this doc:
+///```cpp
+///typedef jpcre2::select<Char_T> jp;
+///```
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+#ifdef JPCRE2_USE_FLAT_MAP
+template<typename Char_T, template<typename...> class Map=FlatMap, typename Alloc=std::allocator<Char_T> >
+#else
+template<typename Char_T, template<typename...> class Map=std::map, typename Alloc=std::allocator<Char_T> >
+#endif
+#else
+template<typename Char_T>
+#endif
+struct select{
+
+    ///Typedef for character (`char`, `wchar_t`, `char16_t`, `char32_t`)
+    typedef Char_T Char;
+
+    //typedef Char_T Char;
+    ///Typedef for string (`std::string`, `std::wstring`, `std::u16string`, `std::u32string`).
+    ///Defined as `std::basic_string<Char_T>`.
+    ///May be this list will make more sense:
+    ///Character  | String
+    ///---------  | -------
+    ///char | std::string
+    ///wchar_t | std::wstring
+    ///char16_t | std::u16string (>=C++11)
+    ///char32_t | std::u32string (>=C++11)
+    ///
+    ///In `>= C++11` it's `std::basic_string<Char_T, std::char_traits<Char_T>, Alloc>`.
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    typedef typename std::basic_string<Char_T, std::char_traits<Char_T>, Alloc> String;
+    ///The allocator of String.
+    typedef Alloc Allocator;
+    ///Allocator rebound to `T`, used by the vectors.
+    template<typename T> using AllocatorFor = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    #else
+    typedef typename std::basic_string<Char_T> String;
+    typedef std::allocator<Char_T> Allocator;
+    #endif
+
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    ///Map for Named substrings.
+    typedef class Map<String, String> MapNas;
+    ///Substring name to Substring number map.
+    typedef class Map<String, SIZE_T> MapNtN;
+    #elif defined(JPCRE2_USE_FLAT_MAP)
+    typedef FlatMap<String, String> MapNas;
+    typedef FlatMap<String, SIZE_T> MapNtN;
+    #else
+    ///Map for Named substrings.
+    typedef typename std::map<String, String> MapNas;
+    ///Substring name to Substring number map.
+    typedef typename std::map<String, SIZE_T> MapNtN;
+    #endif
+
+    ///Allow spelling mistake of MapNtN as MapNtn.
+    typedef MapNtN MapNtn;
+
+    ///Vector for Numbered substrings (Sub container).
+    #ifdef JPCRE2_UNSET_CAPTURES_NULL
+    typedef typename std::vector<std::optional<String>, AllocatorFor<std::optional<String>>> NumSub;
+    #elif defined(JPCRE2_USE_MINIMUM_CXX_11)
+    typedef typename std::vector<String, AllocatorFor<String>> NumSub;
+    #else
+    typedef typename std::vector<String> NumSub;
+    #endif
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    ///Vector of matches with named substrings.
+    typedef typename std::vector<MapNas, AllocatorFor<MapNas>> VecNas;
+    ///Vector of substring name to substring number map.
+    typedef typename std::vector<MapNtN, AllocatorFor<MapNtN>> VecNtN;
+    #else
+    typedef typename std::vector<MapNas> VecNas;
+    typedef typename std::vector<MapNtN> VecNtN;
+    #endif
+    ///Allow spelling mistake of VecNtN as VecNtn.
+    typedef VecNtN VecNtn;
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    ///Vector of matches with numbered substrings.
+    typedef typename std::vector<NumSub, AllocatorFor<NumSub>> VecNum;
+    ///Vector of strings (subjects and results of RegexReplace::replaceBatch()).
+    typedef typename std::vector<String, AllocatorFor<String>> VecStr;
+    #else
+    typedef typename std::vector<NumSub> VecNum;
+    typedef typename std::vector<String> VecStr;
+    #endif
+
+    ///String taking its memory from a jpcre2::Arena (see RegexMatch::setNumberedSubstringVector(ArenaVecNum*)).
+    typedef typename std::basic_string<Char_T, std::char_traits<Char_T>, ArenaAllocator<Char_T> > ArenaString;
+    ///Numbered substrings with arena memory, like NumSub.
+    #ifdef JPCRE2_UNSET_CAPTURES_NULL
+    typedef typename std::vector<std::optional<ArenaString>, ArenaAllocator<std::optional<ArenaString>>> ArenaNumSub;
+    #else
+    typedef typename std::vector<ArenaString, ArenaAllocator<ArenaString> > ArenaNumSub;
+    #endif
+    ///Vector of matches with numbered substrings with arena memory, like VecNum.
+    typedef typename std::vector<ArenaNumSub, ArenaAllocator<ArenaNumSub> > ArenaVecNum;
+    ///Map for named substrings with arena memory, like MapNas (it's always a `std::map`).
+    typedef typename std::map<ArenaString, ArenaString, std::less<ArenaString>,
+                              ArenaAllocator<std::pair<ArenaString const, ArenaString> > > ArenaMapNas;
+    ///Vector of matches with named substrings with arena memory, like VecNas.
+    typedef typename std::vector<ArenaMapNas, ArenaAllocator<ArenaMapNas> > ArenaVecNas;
+
+    //These are to shorten the code
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::Pcre2Uchar Pcre2Uchar;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::Pcre2Sptr Pcre2Sptr;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::Pcre2Code Pcre2Code;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::CompileContext CompileContext;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::MatchData MatchData;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::GeneralContext GeneralContext;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::MatchContext MatchContext;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::JitCallback JitCallback;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::JitStack JitStack;
+    typedef typename Pcre2Type<sizeof( Char_T ) * CHAR_BIT>::CalloutBlock CalloutBlock;
+
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    //Deadline, timeout and cancel token of a match or replace (see RegexMatch::setDeadline()).
+    //It's checked before each match of a global match or replace and by the callouts of a match.
+    struct Deadline {
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point at;       //max() for none
+        Clock::duration timeout;    //from the start of each operation, zero for none
+        CancelToken const* token;
+        Clock::time_point end;      //of the running operation, see start()
+        int error;                  //ERROR::TIMEOUT or ERROR::CANCELLED once it has expired
+
+        Deadline():at(Clock::time_point::max()), timeout(Clock::duration::zero()), token(0),
+                   end(Clock::time_point::max()), error(0){}
+
+        bool isSet() const {
+            return token || at != Clock::time_point::max() || timeout != Clock::duration::zero();
+        }
+
+        //Starts an operation.
+        void start(){
+            end = at;
+            if(timeout != Clock::duration::zero()){
+                Clock::time_point t = Clock::now() + timeout;
+                if(t < end) end = t;
+            }
+            error = 0;
+        }
+
+        //A copy for the parts of the running operation that are done by other objects (e.g on other threads).
+        Deadline running() const {
+            Deadline d = *this;
+            d.at = end;
+            d.timeout = Clock::duration::zero();
+            return d;
+        }
+
+        //Whether the running operation must stop; sets error if so.
+        bool expired(){
+            if(error) return true;
+            if(token && token->isCancelled()) error = (int) ERROR::CANCELLED;
+            else if(end != Clock::time_point::max() && Clock::now() >= end) error = (int) ERROR::TIMEOUT;
+            return error != 0;
+        }
+    };
+    #endif
+
+    //Match, depth and heap limits (see RegexMatch::setMatchLimit()), 0 for not set,
+    //and the callout function (see RegexMatch::setCallout()).
+    struct MatchLimits {
+        uint32_t match;
+        uint32_t depth;
+        uint32_t heap;
+        int (*callout)(CalloutBlock*, void*); //null for none
+        void* callout_data;
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        Deadline* deadline; //checked by the callouts of the match, null for none
+        #endif
+
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        MatchLimits():match(0), depth(0), heap(0), callout(0), callout_data(0), deadline(0){}
+        #else
+        MatchLimits():match(0), depth(0), heap(0), callout(0), callout_data(0){}
+        #endif
+
+        bool any() const {
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(deadline) return true;
+            #endif
+            return match || depth || heap || callout;
+        }
+
+        bool hasCallout() const {
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(deadline) return true;
+            #endif
+            return callout != 0;
+        }
+
+        //Set as the callout function of the match context with the limits as data: it abandons the
+        //match once the deadline has expired, then calls the callout function.
+        static int chainCallout(CalloutBlock* cb, void* data){
+            MatchLimits const* l = static_cast<MatchLimits const*>(data);
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(l->deadline && l->deadline->expired()) return PCRE2_ERROR_CALLOUT;
+            #endif
+            return l->callout ? l->callout(cb, l->callout_data) : 0;
+        }
+
+        //These limits with the ones that aren't set taken from l.
+        MatchLimits over(MatchLimits const& l) const {
+            MatchLimits r = *this;
+            if(!r.match) r.match = l.match;
+            if(!r.depth) r.depth = l.depth;
+            if(!r.heap) r.heap = l.heap;
+            return r;
+        }
+
+        bool operator==(MatchLimits const& l) const {
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(deadline != l.deadline) return false;
+            #endif
+            return match == l.match && depth == l.depth && heap == l.heap
+                   && callout == l.callout && callout_data == l.callout_data;
+        }
+    };
+
+    //A copy of a match context with the match limits, the callout and a JIT stack set on it, so that
+    //the context set by the user (which may be shared by other objects and threads) isn't changed. The JIT stack
+    //grows as needed up to a limit: RegexMatch and RegexReplace retry a match that failed with
+    //PCRE2_ERROR_JIT_STACKLIMIT with it (see RegexMatch::setJitStackLimit()). It's used by one thread at a time;
+    //copies start empty.
+    class MatchContextHolder {
+        MatchContext* ctx;
+        MatchContext const* base; //the context ctx is a copy of (null for default)
+        MatchLimits limits;       //set on ctx
+        JitStack* stack;
+        PCRE2_SIZE max;
+
+        void freeContext(){
+            if(ctx) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_context_free(ctx);
+            ctx = 0;
+        }
+
+        //Makes ctx: a copy of mc with the limits and the JIT stack.
+        bool make(MatchContext* mc, MatchLimits const& l){
+            freeContext();
+            ctx = mc ? Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_context_copy(mc)
+                     : Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_context_create(getGeneralContext());
+            if(!ctx) return false;
+            if(l.match) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_match_limit(ctx, l.match);
+            if(l.depth) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_depth_limit(ctx, l.depth);
+            if(l.heap) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_heap_limit(ctx, l.heap);
+            limits = l;
+            if(l.hasCallout()) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_callout(ctx, &MatchLimits::chainCallout, &limits);
+            if(stack) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_stack_assign(ctx, 0, stack);
+            base = mc;
+            return true;
+        }
+
+        public:
+
+        MatchContextHolder():ctx(0), base(0), stack(0), max(0){}
+        MatchContextHolder(MatchContextHolder const&):ctx(0), base(0), stack(0), max(0){}
+        MatchContextHolder& operator=(MatchContextHolder const&){ return *this; }
+        ~MatchContextHolder(){
+            freeContext();
+            if(stack) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_stack_free(stack);
+        }
+
+        //The context to match with: mc if there's nothing to set on it, otherwise the copy of it.
+        //Without mc, one made with the general context (see setGeneralContext()), it has the memory
+        //functions for the heap of the match.
+        MatchContext* context(MatchContext* mc, MatchLimits const& l){
+            if(!stack && !l.any() && (mc || !getGeneralContext())) return mc;
+            if(ctx && base == mc && limits == l) return ctx;
+            return make(mc, l) ? ctx : mc;
+        }
+
+        //Makes a JIT stack of at most `limit` bytes to retry a match with.
+        //Returns false if there's nothing bigger to retry with.
+        bool grow(MatchContext* mc, MatchLimits const& l, PCRE2_SIZE limit){
+            if(limit <= 32768 || (stack && max >= limit)) return false; //32K is PCRE2's default
+            JitStack* js = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_stack_create(32768, limit, getGeneralContext());
+            if(!js) return false;
+            freeContext(); //it may point to the old stack
+            if(stack) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_stack_free(stack);
+            stack = js;
+            max = limit;
+            return make(mc, l);
+        }
+    };
+
+    ///Set the general context used for the memory PCRE2 allocates for JPCRE2.
+    ///The compiled code, compile and match contexts, match data blocks, JIT stacks, serialized bytes
+    ///and character tables made by Regex, RegexMatch, RegexReplace and MatchEvaluator of this
+    ///code unit width (`sizeof(Char_T)`) are then allocated with its malloc and free functions.
+    ///Objects made with your own contexts (e.g RegexMatch::setMatchContext()) use those.
+    ///
+    ///PCRE2 copies the memory functions into every block it allocates, so the context can be freed
+    ///once it's unset, but the data passed to its functions must live as long as those blocks.
+    ///It's a process wide setting: set it before any other thread uses JPCRE2. JIT compiled
+    ///machine code is allocated by PCRE2's own executable memory allocator, not through it.
+    ///@param gcontext Pointer to a general context (see createGeneralContext()), null for `malloc()` and `free()`.
+    ///@see getGeneralContext()
+    static void setGeneralContext(GeneralContext* gcontext){
+        GeneralContextOf<sizeof( Char_T ) * CHAR_BIT>::get() = gcontext;
+    }
+
+    ///Get the general context set with setGeneralContext().
+    ///@return Pointer to the general context or null.
+    static GeneralContext* getGeneralContext(){
+        return GeneralContextOf<sizeof( Char_T ) * CHAR_BIT>::get();
+    }
+
+    ///Create a general context with custom memory functions (`pcre2_general_context_create()`).
+    ///@param private_malloc Function to allocate `size` bytes, called as `private_malloc(size, memory_data)`.
+    ///@param private_free Function to free memory, called as `private_free(pointer, memory_data)`.
+    ///@param memory_data Data passed to them.
+    ///@return Pointer to the general context, null if it couldn't be allocated. Free it with freeGeneralContext().
+    static GeneralContext* createGeneralContext(void* (*private_malloc)(PCRE2_SIZE, void*),
+                                                void (*private_free)(void*, void*), void* memory_data = 0){
+        return Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::general_context_create(private_malloc, private_free, memory_data);
+    }
+
+    ///Free a general context made with createGeneralContext().
+    ///@param gcontext Pointer to the general context.
+    static void freeGeneralContext(GeneralContext* gcontext){
+        Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::general_context_free(gcontext);
+    }
+
+    //Whether an error number is for a match that gave up on a limit.
+    static bool isLimitError(int err){
+        return err == PCRE2_ERROR_MATCHLIMIT || err == PCRE2_ERROR_DEPTHLIMIT
+               || err == PCRE2_ERROR_HEAPLIMIT || err == PCRE2_ERROR_JIT_STACKLIMIT;
+    }
+
+    template<typename T>
+    static String toString(T); //prevent implicit type conversion of T
+
+    ///Converts a Char_T to jpcre2::select::String
+    ///@param a Char_T
+    ///@return jpcre2::select::String
+    static String toString(Char a){
+        return a?String(1, a):String();
+    }
+
+    ///@overload
+    ///...
+    ///Converts a Char_T const * to jpcre2::select::String
+    ///@param a Char_T const *
+    ///@return jpcre2::select::String
+    static String toString(Char const *a){
+        return a?String(a):String();
     }
 
     ///@overload
@@ -1336,6 +2502,12 @@ struct select{
         return a?String((Char*) a):String();
     }
 
+    //A copy of s with the allocator of s, the copy constructor may give it a default one (e.g `std::pmr`).
+    //Strings made from a subject (the results of a replace) take its allocator this way.
+    static String copyOf(String const& s) {
+        return String(s, 0, String::npos, s.get_allocator());
+    }
+
     ///Retruns error message from PCRE2 error number
     ///@param err_num error number (negative)
     ///@return message as jpcre2::select::String.
@@ -1351,9 +2523,15 @@ struct select{
     ///@return message as jpcre2::select::String.
     static String getErrorMessage(int err_num, int err_off)  {
         if(err_num == (int)ERROR::INVALID_MODIFIER){
-            return MSG<Char>::INVALID_MODIFIER() + toString((Char)err_off);
+            return toString(MSG<Char>::INVALID_MODIFIER().c_str()) + toString((Char)err_off);
         } else if(err_num == (int)ERROR::INSUFFICIENT_OVECTOR){
-            return MSG<Char>::INSUFFICIENT_OVECTOR();
+            return toString(MSG<Char>::INSUFFICIENT_OVECTOR().c_str());
+        } else if(err_num == (int)ERROR::FILE_IO){
+            return toString(MSG<Char>::FILE_IO().c_str());
+        } else if(err_num == (int)ERROR::TIMEOUT){
+            return toString(MSG<Char>::TIMEOUT().c_str());
+        } else if(err_num == (int)ERROR::CANCELLED){
+            return toString(MSG<Char>::CANCELLED().c_str());
         } else if(err_num != 0) {
             return getPcre2ErrorMessage((int) err_num);
         } else return String();
@@ -1364,6 +2542,9 @@ struct select{
     class RegexMatch;
     class RegexReplace;
     class MatchEvaluator;
+    class RegexCache;
+    class MatchTable;
+    class MatchResult;
 
     /** Provides public constructors to create RegexMatch objects.
      * Every RegexMatch object should be associated with a Regex object.
@@ -1397,9 +2578,30 @@ struct select{
         MatchContext *mcontext;
         ModifierTable const * modtab;
         MatchData * mdata;
+        PCRE2_SIZE jit_stack_limit;
+        MatchLimits limits;
+        MatchContextHolder own_mcontext;
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        Deadline deadline;
+        #endif
 
         PCRE2_SIZE _start_offset; //name collision, use _ at start
 
+        //Matches starting at or after _stop_offset are not taken, the first such match is
+        //left in _next_match instead. Used to search a chunk of the subject.
+        PCRE2_SIZE _stop_offset;
+        PCRE2_SIZE _next_match[2];
+
+        //PCRE2_NO_UTF_CHECK if the subject has already been checked (for a chunk).
+        Uint utf_checked;
+
+        #ifdef JPCRE2_USE_THREADS
+        ThreadPool* pool;
+        PCRE2_SIZE chunk_size;
+
+        bool chunkedMatch(SIZE_T*);
+        #endif
+
         VecNum* vec_num;
         VecNas* vec_nas;
         VecNtN* vec_ntn;
@@ -1407,17 +2609,191 @@ struct select{
         VecOff* vec_soff;
         VecOff* vec_eoff;
 
+        MatchTable* table;
+
+        //Caller's array for the offsets of the matches (see setOffsetBuffer()).
+        PCRE2_SIZE* obuf;
+        SIZE_T obuf_matches;    //room in matches
+        uint32_t obuf_groups;   //groups of each match
+        SIZE_T obuf_count;      //matches stored by the last match()
+        bool obuf_truncated;
+
+        //Stores the offsets of a match in obuf, missing groups are unset.
+        void pushOffsets(PCRE2_SIZE const* ovector, uint32_t n){
+            PCRE2_SIZE* p = obuf + 2 * obuf_count * obuf_groups;
+            uint32_t k = n < obuf_groups ? n : obuf_groups;
+            for(uint32_t i = 0; i < 2 * k; ++i) p[i] = ovector[i];
+            for(uint32_t i = 2 * k; i < 2 * obuf_groups; ++i) p[i] = PCRE2_UNSET;
+            ++obuf_count;
+        }
+
+        //Substrings with their memory in the arena (see setArenaNumberedSubstringVector()).
+        ArenaVecNum* avec_num;
+        ArenaVecNas* avec_nas;
+        Arena arena;
+
+        //Results of the previous match kept for their memory (see setReuseResults()).
+        bool reuse_results;
+        SIZE_T reuse_code; //id of the code the kept maps were filled for (see Regex::codeId())
+        VecNum spare_num;
+        VecNas spare_nas;
+        VecNtN spare_ntn;
+
+        //Capture groups to extract (see addCaptureGroup()), all if none is added.
+        std::vector<uint32_t> proj_numbers;
+        std::vector<String> proj_names;
+        std::vector<unsigned char> proj_mask; //proj_mask[n] for group n, empty for all
+        uint32_t proj_end;                    //the highest group to extract + 1
+        SIZE_T proj_code;                     //id of the code proj_mask was made for
+
+        //Makes proj_mask for the code of re, the names are looked up once for each code.
+        void resolveCaptureGroups(){
+            if(proj_code == Regex::codeId(re)) return;
+            proj_code = Regex::codeId(re);
+            proj_mask.clear();
+            proj_end = 0;
+            if(proj_numbers.empty() && proj_names.empty()) return;
+            proj_mask.assign(re->shared->groups, 0);
+            for(SIZE_T i = 0; i < proj_numbers.size(); ++i)
+                if(proj_numbers[i] < proj_mask.size()) proj_mask[proj_numbers[i]] = 1;
+            std::vector<std::pair<String, uint32_t> > const& names = re->shared->names;
+            for(SIZE_T i = 0; i < proj_names.size(); ++i){
+                typename std::vector<std::pair<String, uint32_t> >::const_iterator it =
+                    std::lower_bound(names.begin(), names.end(), std::make_pair(proj_names[i], (uint32_t) 0), Regex::nameLess);
+                for(; it != names.end() && it->first == proj_names[i]; ++it) proj_mask[it->second] = 1; //all groups of a duplicate name
+            }
+            for(uint32_t n = 0; n < proj_mask.size(); ++n) if(proj_mask[n]) proj_end = n + 1;
+            if(proj_mask.empty()) proj_mask.push_back(0); //nothing to extract is not all
+        }
+
+        //Whether group n is extracted.
+        bool isExtracted(uint32_t n) const {
+            return proj_mask.empty() || (n < proj_mask.size() && proj_mask[n]);
+        }
+
+        //Moves the results in v to spare, which is used from the back: the i-th result of the next match
+        //gets the memory of the i-th one of this match.
+        template<typename Vec>
+        static void keepResults(Vec* v, Vec& spare){
+            if(!v) return;
+            if(!(v->get_allocator() == spare.get_allocator())){ //their memory can't be swapped (e.g std::pmr)
+                v->clear();
+                Vec().swap(spare);
+                return;
+            }
+            SIZE_T n = spare.size(), m = v->size();
+            spare.resize(n + m);
+            for(SIZE_T i = 0; i < m; ++i) spare[n + m - 1 - i].swap((*v)[i]);
+            v->clear(); //the elements are empty now
+        }
+
+        //Frees the arena, the elements of the arena vectors using it are removed first.
+        void releaseArena(){
+            if (avec_num) avec_num->clear();
+            if (avec_nas) avec_nas->clear();
+            arena.release();
+        }
+
+        template<typename Vec>
+        static void shrinkVector(Vec* v){
+            if(v) Vec(v->begin(), v->end(), v->get_allocator()).swap(*v);
+        }
+
+        //Empties the result vectors for a new match.
+        void clearResults(){
+            if(reuse_results){
+                keepResults(vec_num, spare_num);
+                keepResults(vec_nas, spare_nas);
+                keepResults(vec_ntn, spare_ntn);
+                if(reuse_code != Regex::codeId(re)){ //the names may differ
+                    for(SIZE_T i = 0; i < spare_nas.size(); ++i) spare_nas[i].clear();
+                    for(SIZE_T i = 0; i < spare_ntn.size(); ++i) spare_ntn[i].clear();
+                    reuse_code = Regex::codeId(re);
+                }
+            } else {
+                if (vec_num) vec_num->clear();
+                if (vec_nas) vec_nas->clear();
+                if (vec_ntn) vec_ntn->clear();
+            }
+            if (vec_soff) vec_soff->clear();
+            if (vec_eoff) vec_eoff->clear();
+            if (avec_num || avec_nas) {
+                if (avec_num) avec_num->clear();
+                if (avec_nas) avec_nas->clear();
+                arena.reset(); //after the elements that use it are gone
+            }
+        }
+
         bool getNumberedSubstrings(int, Pcre2Sptr, PCRE2_SIZE*, uint32_t);
 
+        //Goes straight to pcre2_jit_match() when the code is JIT compiled and the checks done by
+        //pcre2_match() aren't needed (see Regex::jitMatchCode()).
+        int matchWith(MatchContext* mc, Pcre2Sptr subject, PCRE2_SIZE length, PCRE2_SIZE offset, Uint opts, MatchData* md){
+            Pcre2Code* jc = (offset <= length) ? re->jitMatchCode(opts) : 0;
+            if(jc) return Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_match(jc, subject, length, offset, opts, md, mc);
+            return Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match(re->matchCode(), subject, length, offset, opts, md, mc);
+        }
+
+        //The limits to match with: these, then the ones of the Regex object.
+        MatchLimits matchLimits() const {
+            return re ? limits.over(re->limits) : limits;
+        }
+
+        //Match with the match context to use, retried on a bigger JIT stack if it runs out of stack
+        //(see setJitStackLimit()).
+        int matchAt(Pcre2Sptr subject, PCRE2_SIZE length, PCRE2_SIZE offset, Uint opts, MatchData* md){
+            MatchLimits l = matchLimits();
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(deadline.isSet()){
+                if(deadline.expired()) return PCRE2_ERROR_CALLOUT; //see matchError()
+                l.deadline = &deadline;
+            }
+            #endif
+            int rc = matchWith(own_mcontext.context(mcontext, l), subject, length, offset, opts, md);
+            if(rc == PCRE2_ERROR_JIT_STACKLIMIT && own_mcontext.grow(mcontext, l, jit_stack_limit))
+                rc = matchWith(own_mcontext.context(mcontext, l), subject, length, offset, opts, md);
+            return rc;
+        }
+
+        //The error number for a failed match: the deadline's if it stopped the match.
+        int matchError(int rc) const {
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(rc == PCRE2_ERROR_CALLOUT && deadline.error) return deadline.error;
+            #endif
+            return rc;
+        }
+
         bool getNamedSubstrings(int, int, Pcre2Sptr, Pcre2Sptr, PCRE2_SIZE*);
 
         void init_vars() {
             re = 0;
+            _stop_offset = PCRE2_UNSET;
+            _next_match[0] = _next_match[1] = PCRE2_UNSET;
+            utf_checked = 0;
+            #ifdef JPCRE2_USE_THREADS
+            pool = 0;
+            chunk_size = JPCRE2_DEFAULT_CHUNK_SIZE;
+            #endif
             vec_num = 0;
             vec_nas = 0;
             vec_ntn = 0;
             vec_soff = 0;
             vec_eoff = 0;
+            table = 0;
+            obuf = 0;
+            obuf_matches = 0;
+            obuf_groups = 0;
+            obuf_count = 0;
+            obuf_truncated = false;
+            avec_num = 0;
+            avec_nas = 0;
+            reuse_results = false;
+            reuse_code = 0;
+            proj_numbers.clear();
+            proj_names.clear();
+            proj_mask.clear();
+            proj_end = 0;
+            proj_code = 0;
             match_opts = 0;
             jpcre2_match_opts = 0;
             error_number = 0;
@@ -1427,6 +2803,11 @@ struct select{
             mcontext = 0;
             modtab = 0;
             mdata = 0;
+            jit_stack_limit = JPCRE2_DEFAULT_JIT_STACK_LIMIT;
+            limits = MatchLimits();
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            deadline = Deadline();
+            #endif
         }
 
         void onlyCopy(RegexMatch const &rm){
@@ -1443,6 +2824,20 @@ struct select{
             vec_ntn = rm.vec_ntn;
             vec_soff = rm.vec_soff;
             vec_eoff = rm.vec_eoff;
+            table = rm.table;
+            obuf = rm.obuf;
+            obuf_matches = rm.obuf_matches;
+            obuf_groups = rm.obuf_groups;
+            obuf_count = rm.obuf_count;
+            obuf_truncated = rm.obuf_truncated;
+            avec_num = 0; //tied to the arena of rm, which clears them
+            avec_nas = 0;
+            reuse_results = rm.reuse_results; //not the kept results
+            proj_numbers = rm.proj_numbers;
+            proj_names = rm.proj_names;
+            proj_mask = rm.proj_mask;
+            proj_end = rm.proj_end;
+            proj_code = rm.proj_code;
 
             match_opts = rm.match_opts;
             jpcre2_match_opts = rm.jpcre2_match_opts;
@@ -1452,6 +2847,15 @@ struct select{
             mcontext = rm.mcontext;
             modtab = rm.modtab;
             mdata = rm.mdata;
+            jit_stack_limit = rm.jit_stack_limit;
+            limits = rm.limits;
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            deadline = rm.deadline;
+            #endif
+            #ifdef JPCRE2_USE_THREADS
+            pool = rm.pool;
+            chunk_size = rm.chunk_size;
+            #endif
         }
 
         void deepCopy(RegexMatch const &rm){
@@ -1538,7 +2942,10 @@ struct select{
 
         ///Destructor
         ///Frees all internal memories that were used.
-        virtual ~RegexMatch() {}
+        ///The arena vectors (see setArenaNumberedSubstringVector()) are cleared, as their substrings are freed.
+        virtual ~RegexMatch() {
+            releaseArena();
+        }
 
         ///Reset all class variables to its default (initial) state including memory.
         ///Data in the vectors will retain (as it's external)
@@ -1546,6 +2953,10 @@ struct select{
         ///@return Reference to the calling RegexMatch object.
         virtual RegexMatch& reset() {
             String().swap(m_subject); //not ptr , external string won't be modified.
+            VecNum().swap(spare_num);
+            VecNas().swap(spare_nas);
+            VecNtN().swap(spare_ntn);
+            releaseArena();
             init_vars();
             return *this;
         }
@@ -1590,7 +3001,7 @@ struct select{
         ///@return Last error message
         virtual String getErrorMessage() const  {
             #ifdef JPCRE2_USE_MINIMUM_CXX_11
-            return select<Char, Map>::getErrorMessage(error_number, error_offset);
+            return select<Char, Map, Alloc>::getErrorMessage(error_number, error_offset);
             #else
             return select<Char>::getErrorMessage(error_number, error_offset);
             #endif
@@ -1600,7 +3011,7 @@ struct select{
         ///@return subject string
         ///@see RegexReplace::getSubject()
         virtual String getSubject() const  {
-            return *m_subject_ptr;
+            return copyOf(*m_subject_ptr);
         }
 
         ///Get pointer to subject string.
@@ -1701,6 +3112,43 @@ struct select{
             return vec_ntn;
         }
 
+        ///Get pointer to the match table.
+        ///@return Pointer to const match table.
+        virtual MatchTable const* getMatchTable() const {
+            return table;
+        }
+
+        ///Get the number of matches the last match() stored in the offset buffer (see setOffsetBuffer()).
+        ///@return Number of matches.
+        virtual SIZE_T getOffsetBufferCount() const {
+            return obuf_count;
+        }
+
+        ///Check whether the results of the last match() didn't fit in the offset buffer (see setOffsetBuffer()):
+        ///there was a match after it was full, or the pattern has more groups than it takes.
+        ///@return true if truncated.
+        virtual bool isOffsetBufferTruncated() const {
+            return obuf_truncated;
+        }
+
+        ///Get pointer to the numbered substring vector with arena memory.
+        ///@return Pointer to const numbered substring vector.
+        virtual ArenaVecNum const* getArenaNumberedSubstringVector() const {
+            return avec_num;
+        }
+
+        ///Get pointer to the named substring vector with arena memory.
+        ///@return Pointer to const named substring vector.
+        virtual ArenaVecNas const* getArenaNamedSubstringVector() const {
+            return avec_nas;
+        }
+
+        ///Get the arena that holds the substrings of the arena vectors.
+        ///@return Reference to the arena.
+        virtual Arena const& getArena() const {
+            return arena;
+        }
+
         ///Set the associated regex object.
         ///Null pointer unsets it.
         ///Underlying data is not modified.
@@ -1764,6 +3212,144 @@ struct select{
             return *this;
         }
 
+        /// Set a pointer to a match table to store the offsets of all groups of all matches
+        /// in one array (see jpcre2::select::MatchTable).
+        /// Null pointer unsets it.
+        ///
+        /// It can be used instead of, or along with, the vectors. Substrings are taken from the table
+        /// on demand, the subject must be kept alive and unchanged until then.
+        /// @param t Pointer to a MatchTable object
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& setMatchTable(MatchTable* t){
+            table = t;
+            return *this;
+        }
+
+        /// Set an array of your own to store the offsets of the matches in, instead of growing vectors.
+        ///
+        /// match() writes the start and end offsets of the first `groups` groups of each match to it:
+        /// `buf[2*(m*groups + g)]` and `buf[2*(m*groups + g) + 1]` for the group `g` of the match `m`,
+        /// PCRE2_UNSET for groups that are unset or that the pattern doesn't have. The search stops when
+        /// `max_matches` matches are stored: match() then returns the number of matches stored
+        /// (getOffsetBufferCount()) and isOffsetBufferTruncated() tells whether there was one more, or whether
+        /// the pattern has more groups than `groups`.
+        ///
+        /// Nothing is allocated or thrown on the way. With a match data block (setMatchDataBlock()) and no
+        /// vectors, match table or thread pool, match() doesn't allocate memory once PCRE2 has made its
+        /// working memory in the match data block and the match context (on the first match): it can be used
+        /// in real-time threads. The array is not owned by the RegexMatch object. Null pointer unsets it.
+        /// @param buf Array of at least `2 * max_matches * groups` offsets.
+        /// @param max_matches Number of matches it has room for.
+        /// @param groups Number of groups of each match, including group 0 (the whole match).
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& setOffsetBuffer(PCRE2_SIZE* buf, SIZE_T max_matches, uint32_t groups = 1){
+            obuf = buf;
+            obuf_matches = buf ? max_matches : 0;
+            obuf_groups = groups;
+            return *this;
+        }
+
+        /// Set a pointer to a numbered substring vector whose substrings take their memory from the arena
+        /// of this object, instead of a heap allocation for each of them.
+        /// Null pointer unsets it.
+        ///
+        /// It's filled like the vector set with setNumberedSubstringVector(). match() clears it and resets the
+        /// arena, freeing the substrings of the previous match in one go; the substrings (and their copies,
+        /// which use the same arena) are thus valid until the next match(), reset() or the destruction of
+        /// this object, which also clear the vector: it must outlive this object, or be unset before it's
+        /// destroyed. Copy the substrings into a String to keep them longer.
+        /// A copy of this object does not have the arena vectors set.
+        /// @param v pointer to the numbered substring vector
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& setArenaNumberedSubstringVector(ArenaVecNum* v) {
+            avec_num = v;
+            return *this;
+        }
+
+        /// Set a pointer to a named substring vector whose maps and substrings take their memory from the arena
+        /// of this object (see setArenaNumberedSubstringVector()).
+        /// Null pointer unsets it.
+        /// @param v pointer to the named substring vector
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& setArenaNamedSubstringVector(ArenaVecNas* v) {
+            avec_nas = v;
+            return *this;
+        }
+
+        /// Set whether to keep the memory of the match results for the next match.
+        ///
+        /// By default, match() clears the result vectors, destroying the substring vectors, maps and strings of
+        /// each match, and makes them again. With this set, they are kept in this object and filled in place by
+        /// the next match, reusing the capacity of their strings; a pattern matched many times over similar
+        /// subjects then doesn't allocate once it has warmed up. The vectors are still cleared (`size()` is the
+        /// match count); the memory is only freed by shrinkResults(), reset() or the destructor.
+        ///
+        /// Results made by a parallel match (see setThreadPool()) are not reused, nor are those of vectors whose
+        /// allocator isn't equal to a default constructed one (e.g `std::pmr` vectors with their own resource).
+        /// @param x true to reuse, false (default) to not.
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& setReuseResults(bool x = true){
+            reuse_results = x;
+            return *this;
+        }
+
+        /// Add a capture group to extract.
+        ///
+        /// By default match() copies every group to the numbered and named substring vectors.
+        /// Once groups are added, only those are copied: NumSub goes up to the highest of them
+        /// and the others in it are left empty (`std::nullopt` with JPCRE2_UNSET_CAPTURES_NULL),
+        /// MapNas and MapNtN only get the names of these groups. The offsets of the matches
+        /// (setMatchStartOffsetVector(), setMatchTable()) are not affected.
+        /// @param n Group number, 0 for the whole match. Numbers the pattern doesn't have are ignored.
+        /// @return Reference to the calling RegexMatch object
+        /// @see clearCaptureGroups()
+        virtual RegexMatch& addCaptureGroup(uint32_t n){
+            proj_numbers.push_back(n);
+            proj_code = reuse_code = 0; //the kept maps may have other names
+            return *this;
+        }
+
+        /// @overload
+        ///...
+        /// Names are looked up once for each compiled pattern, not for each match.
+        /// @param name Group name, all groups with this name with duplicate names. Unknown names are ignored.
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& addCaptureGroup(String const& name){
+            proj_names.push_back(name);
+            proj_code = reuse_code = 0;
+            return *this;
+        }
+
+        /// Extract all capture groups again (the default), see addCaptureGroup().
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& clearCaptureGroups(){
+            proj_numbers.clear();
+            proj_names.clear();
+            proj_code = reuse_code = 0;
+            return *this;
+        }
+
+        /// Check whether the memory of the match results is reused (see setReuseResults()).
+        /// @return true if reused.
+        virtual bool getReuseResults() const {
+            return reuse_results;
+        }
+
+        /// Free the memory kept for reuse (see setReuseResults()) and shrink the capacity
+        /// of the result vectors that are set to their size.
+        /// @return Reference to the calling RegexMatch object
+        virtual RegexMatch& shrinkResults(){
+            VecNum().swap(spare_num);
+            VecNas().swap(spare_nas);
+            VecNtN().swap(spare_ntn);
+            shrinkVector(vec_num);
+            shrinkVector(vec_nas);
+            shrinkVector(vec_ntn);
+            shrinkVector(vec_soff);
+            shrinkVector(vec_eoff);
+            return *this;
+        }
+
         ///Set the subject string for match.
         ///This makes a copy of the subject string.
         /// @param s Subject string
@@ -1893,6 +3479,221 @@ struct select{
             return mdata;
         }
 
+        ///Set the maximum size of the JIT stack for patterns that need more than the default.
+        ///
+        ///JIT compiled patterns use a 32K stack by default (on the machine stack). When a match fails with
+        ///`PCRE2_ERROR_JIT_STACKLIMIT`, it's retried with a JIT stack that grows as needed up to `n` bytes.
+        ///The stack belongs to this object (each thread of a parallel match has its own) and is kept for the
+        ///following matches. It's assigned to a copy of the match context (see setMatchContext()) that is made
+        ///along with the stack.
+        ///Default is `JPCRE2_DEFAULT_JIT_STACK_LIMIT` (1048576), 0 (or a value not larger than 32K) disables it.
+        ///@param n Maximum JIT stack size in bytes.
+        ///@return Reference to the calling RegexMatch object
+        ///@see RegexReplace::setJitStackLimit()
+        virtual RegexMatch& setJitStackLimit(PCRE2_SIZE n){
+            jit_stack_limit = n;
+            return *this;
+        }
+
+        ///Get the maximum JIT stack size.
+        ///@return JIT stack limit in bytes.
+        virtual PCRE2_SIZE getJitStackLimit() const {
+            return jit_stack_limit;
+        }
+
+        ///Set the match limit (`pcre2_set_match_limit()`) to bound the time a match can take.
+        ///
+        ///A match that exceeds it fails with `PCRE2_ERROR_MATCHLIMIT` (see isLimitExceeded()).
+        ///The limits are set on a copy of the match context (see setMatchContext()) that belongs to this object
+        ///and is reused by the following matches; each thread of a parallel match has its own.
+        ///A limit that is not set (0) is taken from the Regex object (see Regex::setMatchLimit()), then from the
+        ///match context or PCRE2's default.
+        ///@param n Match limit, 0 to unset.
+        ///@return Reference to the calling RegexMatch object
+        ///@see setDepthLimit()
+        ///@see setHeapLimit()
+        virtual RegexMatch& setMatchLimit(uint32_t n){
+            limits.match = n;
+            return *this;
+        }
+
+        ///Set the depth limit (`pcre2_set_depth_limit()`, not used by JIT matches).
+        ///A match that exceeds it fails with `PCRE2_ERROR_DEPTHLIMIT`.
+        ///@param n Depth limit, 0 to unset.
+        ///@return Reference to the calling RegexMatch object
+        ///@see setMatchLimit()
+        virtual RegexMatch& setDepthLimit(uint32_t n){
+            limits.depth = n;
+            return *this;
+        }
+
+        ///Set the heap limit in kibibytes (`pcre2_set_heap_limit()`, not used by JIT matches).
+        ///A match that exceeds it fails with `PCRE2_ERROR_HEAPLIMIT`.
+        ///@param n Heap limit in KiB, 0 to unset.
+        ///@return Reference to the calling RegexMatch object
+        ///@see setMatchLimit()
+        virtual RegexMatch& setHeapLimit(uint32_t n){
+            limits.heap = n;
+            return *this;
+        }
+
+        ///Get the match limit set with setMatchLimit().
+        ///@return Match limit, 0 if not set.
+        virtual uint32_t getMatchLimit() const {
+            return limits.match;
+        }
+
+        ///Get the depth limit set with setDepthLimit().
+        ///@return Depth limit, 0 if not set.
+        virtual uint32_t getDepthLimit() const {
+            return limits.depth;
+        }
+
+        ///Get the heap limit set with setHeapLimit().
+        ///@return Heap limit in KiB, 0 if not set.
+        virtual uint32_t getHeapLimit() const {
+            return limits.heap;
+        }
+
+        ///Set the callout function of the matches (`pcre2_set_callout()`).
+        ///
+        ///Like the limits, it's set on a copy of the match context (see setMatchContext()). Set it here rather than
+        ///on your own match context if a deadline is set (see setDeadline()): the deadline replaces the callout
+        ///function of the match context, while this one is called after the deadline has been checked.
+        ///@param f Callout function, null to unset.
+        ///@param data Data passed to it.
+        ///@return Reference to the calling RegexMatch object
+        virtual RegexMatch& setCallout(int (*f)(CalloutBlock*, void*), void* data = 0){
+            limits.callout = f;
+            limits.callout_data = data;
+            return *this;
+        }
+
+        ///Check whether the last error is a match that gave up on a limit: the match, depth or heap limit
+        ///(`PCRE2_ERROR_MATCHLIMIT`, `PCRE2_ERROR_DEPTHLIMIT`, `PCRE2_ERROR_HEAPLIMIT`) or the JIT stack limit
+        ///(`PCRE2_ERROR_JIT_STACKLIMIT`), as opposed to no match or an invalid subject or option.
+        ///@return true if a limit was exceeded.
+        ///@see setMatchLimit()
+        virtual bool isLimitExceeded() const {
+            return isLimitError(error_number);
+        }
+
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        ///Set a deadline for the match: a global match stops when it's reached and keeps the matches found before it.
+        ///
+        ///It's checked before each match, and during a match by its callouts: the callout function of the match
+        ///context is replaced with one that abandons the match when the deadline is reached (or the cancel token is
+        ///set) and otherwise calls the one set with setCallout(), thus a single long match can only be stopped if
+        ///the pattern has callouts, e.g `(?C)` in a loop or compiled with `PCRE2_AUTO_CALLOUT`.
+        ///When it stops, the match count and vectors hold the matches found so far and the error number is
+        ///`jpcre2::ERROR::TIMEOUT` (see isTimedOut()).
+        ///@param t Deadline, `std::chrono::steady_clock::time_point::max()` to unset.
+        ///@return Reference to the calling RegexMatch object
+        ///@see setTimeout()
+        ///@see setCancelToken()
+        virtual RegexMatch& setDeadline(std::chrono::steady_clock::time_point t){
+            deadline.at = t;
+            return *this;
+        }
+
+        ///Set a timeout: a deadline that is this long after the start of each match() (see setDeadline()).
+        ///The earlier of this and the one set with setDeadline() is used.
+        ///@param d Timeout, zero to unset.
+        ///@return Reference to the calling RegexMatch object
+        virtual RegexMatch& setTimeout(std::chrono::nanoseconds d){
+            deadline.timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(d);
+            return *this;
+        }
+
+        ///Set a token to stop the match from another thread (see jpcre2::CancelToken and setDeadline()).
+        ///When it's cancelled the error number is `jpcre2::ERROR::CANCELLED` (see isCancelled()).
+        ///@param token Pointer to a cancel token, null to unset.
+        ///@return Reference to the calling RegexMatch object
+        virtual RegexMatch& setCancelToken(CancelToken const* token){
+            deadline.token = token;
+            return *this;
+        }
+
+        ///Get the deadline set with setDeadline().
+        ///@return deadline, `std::chrono::steady_clock::time_point::max()` if not set.
+        virtual std::chrono::steady_clock::time_point getDeadline() const {
+            return deadline.at;
+        }
+
+        ///Get the timeout set with setTimeout().
+        ///@return timeout, zero if not set.
+        virtual std::chrono::nanoseconds getTimeout() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.timeout);
+        }
+
+        ///Get the cancel token set with setCancelToken().
+        ///@return pointer to the cancel token.
+        virtual CancelToken const* getCancelToken() const {
+            return deadline.token;
+        }
+
+        ///Check whether the last match was stopped by the deadline or timeout.
+        ///@return true if it timed out.
+        virtual bool isTimedOut() const {
+            return error_number == (int) ERROR::TIMEOUT;
+        }
+
+        ///Check whether the last match was stopped by the cancel token.
+        ///@return true if it was cancelled.
+        virtual bool isCancelled() const {
+            return error_number == (int) ERROR::CANCELLED;
+        }
+        #endif
+
+        #ifdef JPCRE2_USE_THREADS
+        ///Set a thread pool to run a global match on large subjects in parallel.
+        ///
+        ///When a pool is set and FIND_ALL is on, a subject that is at least twice as long as the chunk size
+        ///(see setChunkSize()) is split into chunks at line boundaries and the chunks are searched on the pool.
+        ///The results are merged in order and are exactly the same as a sequential match: a chunk
+        ///whose first match does not agree with where the search from the previous chunk would have
+        ///continued (e.g a match runs across the chunk boundary) is searched again from the previous chunk
+        ///on the calling thread, thus patterns that span lines only lose the speedup.
+        ///
+        ///Patterns that are anchored or contain `\\G` and matches with partial match options
+        ///are always done sequentially. The match data block set with setMatchDataBlock() is not used
+        ///for a parallel match.
+        ///
+        ///The pool is not owned by the RegexMatch object. Null pointer unsets it.
+        ///Not available if `JPCRE2_DISABLE_THREADS` is defined.
+        ///@param tp Pointer to a jpcre2::ThreadPool object.
+        ///@return Reference to the calling RegexMatch object
+        ///@see RegexReplace::setThreadPool()
+        virtual RegexMatch& setThreadPool(ThreadPool* tp){
+            pool = tp;
+            return *this;
+        }
+
+        ///Get the thread pool that was set with setThreadPool().
+        ///@return pointer to the thread pool (default: null).
+        virtual ThreadPool* getThreadPool() const {
+            return pool;
+        }
+
+        ///Set the size (in code units) of the chunks a subject is split into for a parallel match.
+        ///The actual chunks can be larger as they end at line boundaries and the subject
+        ///is never split into more than four chunks per thread.
+        ///0 disables parallel match. Default is `JPCRE2_DEFAULT_CHUNK_SIZE` (1048576).
+        ///@param n chunk size
+        ///@return Reference to the calling RegexMatch object
+        ///@see setThreadPool()
+        virtual RegexMatch& setChunkSize(PCRE2_SIZE n){
+            chunk_size = n;
+            return *this;
+        }
+
+        ///Get the chunk size for parallel match.
+        ///@return chunk size
+        virtual PCRE2_SIZE getChunkSize() const {
+            return chunk_size;
+        }
+        #endif
+
         /// Parse modifier and add/remove equivalent PCRE2 and JPCRE2 options.
         /// This function does not initialize or re-initialize options.
         /// If you want to set options from scratch, initialize them to 0 before calling this function.
@@ -2078,6 +3879,9 @@ struct select{
     ///* setNameToNumberMapVector
     ///* setMatchStartOffsetVector
     ///* setMatchEndOffsetVector
+    ///* setMatchTable
+    ///* setArenaNumberedSubstringVector
+    ///* setArenaNamedSubstringVector
     ///
     ///The use of above functions is not allowed as the vectors are created according to the callback function you pass.
     ///
@@ -2265,6 +4069,22 @@ struct select{
             RegexMatch::setMatchEndOffsetVector(v);
             return *this;
         }
+        MatchEvaluator& setMatchTable(MatchTable* t){
+            RegexMatch::setMatchTable(t);
+            return *this;
+        }
+        MatchEvaluator& setOffsetBuffer(PCRE2_SIZE* buf, SIZE_T max_matches, uint32_t groups = 1){
+            RegexMatch::setOffsetBuffer(buf, max_matches, groups);
+            return *this;
+        }
+        MatchEvaluator& setArenaNumberedSubstringVector(ArenaVecNum* v){
+            RegexMatch::setArenaNumberedSubstringVector(v);
+            return *this;
+        }
+        MatchEvaluator& setArenaNamedSubstringVector(ArenaVecNas* v){
+            RegexMatch::setArenaNamedSubstringVector(v);
+            return *this;
+        }
 
         public:
 
@@ -2749,13 +4569,139 @@ struct select{
             return *this;
         }
 
-        ///Call RegexMatch::setMatchDataBlock(MatchContext * mdt);
-        ///@param mdt pointer to match data block
+        ///Call RegexMatch::setMatchDataBlock(MatchContext * mdt);
+        ///@param mdt pointer to match data block
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setMatchDataBlock(MatchData* mdt){
+            RegexMatch::setMatchDataBlock(mdt);
+            return *this;
+        }
+
+        #ifdef JPCRE2_USE_THREADS
+        ///Call RegexMatch::setThreadPool(ThreadPool* tp).
+        ///Only the match is done in parallel, the callback is called on the calling thread.
+        ///@param tp pointer to a thread pool.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setThreadPool(ThreadPool* tp){
+            RegexMatch::setThreadPool(tp);
+            return *this;
+        }
+
+        ///Call RegexMatch::setChunkSize(PCRE2_SIZE n).
+        ///@param n chunk size.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setChunkSize(PCRE2_SIZE n){
+            RegexMatch::setChunkSize(n);
+            return *this;
+        }
+        #endif
+
+        ///Call RegexMatch::setJitStackLimit(PCRE2_SIZE n).
+        ///@param n Maximum JIT stack size in bytes.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setJitStackLimit(PCRE2_SIZE n){
+            RegexMatch::setJitStackLimit(n);
+            return *this;
+        }
+
+        ///Call RegexMatch::setMatchLimit(uint32_t n).
+        ///@param n Match limit, 0 to unset.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setMatchLimit(uint32_t n){
+            RegexMatch::setMatchLimit(n);
+            return *this;
+        }
+
+        ///Call RegexMatch::setDepthLimit(uint32_t n).
+        ///@param n Depth limit, 0 to unset.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setDepthLimit(uint32_t n){
+            RegexMatch::setDepthLimit(n);
+            return *this;
+        }
+
+        ///Call RegexMatch::setHeapLimit(uint32_t n).
+        ///@param n Heap limit in KiB, 0 to unset.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setHeapLimit(uint32_t n){
+            RegexMatch::setHeapLimit(n);
+            return *this;
+        }
+
+        ///Call RegexMatch::setCallout(int (*f)(CalloutBlock*, void*), void* data).
+        ///@param f Callout function, null to unset.
+        ///@param data Data passed to it.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setCallout(int (*f)(CalloutBlock*, void*), void* data = 0){
+            RegexMatch::setCallout(f, data);
+            return *this;
+        }
+
+        ///Call RegexMatch::setReuseResults(bool x).
+        ///@param x true to reuse, false to not.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setReuseResults(bool x = true){
+            RegexMatch::setReuseResults(x);
+            return *this;
+        }
+
+        ///Call RegexMatch::shrinkResults().
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& shrinkResults(){
+            RegexMatch::shrinkResults();
+            return *this;
+        }
+
+        ///Call RegexMatch::addCaptureGroup(uint32_t n).
+        ///The callback gets the groups that aren't added empty.
+        ///@param n Group number.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& addCaptureGroup(uint32_t n){
+            RegexMatch::addCaptureGroup(n);
+            return *this;
+        }
+
+        ///Call RegexMatch::addCaptureGroup(String const& name).
+        ///@param name Group name.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& addCaptureGroup(String const& name){
+            RegexMatch::addCaptureGroup(name);
+            return *this;
+        }
+
+        ///Call RegexMatch::clearCaptureGroups().
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& clearCaptureGroups(){
+            RegexMatch::clearCaptureGroups();
+            return *this;
+        }
+
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        ///Call RegexMatch::setDeadline(std::chrono::steady_clock::time_point t).
+        ///The replacement is done with the matches found before the deadline.
+        ///@param t Deadline, `std::chrono::steady_clock::time_point::max()` to unset.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setDeadline(std::chrono::steady_clock::time_point t){
+            RegexMatch::setDeadline(t);
+            return *this;
+        }
+
+        ///Call RegexMatch::setTimeout(std::chrono::nanoseconds d).
+        ///@param d Timeout, zero to unset.
+        ///@return A reference to the calling MatchEvaluator object.
+        MatchEvaluator& setTimeout(std::chrono::nanoseconds d){
+            RegexMatch::setTimeout(d);
+            return *this;
+        }
+
+        ///Call RegexMatch::setCancelToken(CancelToken const* token).
+        ///@param token Pointer to a cancel token, null to unset.
         ///@return A reference to the calling MatchEvaluator object.
-        MatchEvaluator& setMatchDataBlock(MatchData* mdt){
-            RegexMatch::setMatchDataBlock(mdt);
+        MatchEvaluator& setCancelToken(CancelToken const* token){
+            RegexMatch::setCancelToken(token);
             return *this;
         }
+        #endif
 
         ///Set the buffer size that will be used by pcre2_substitute (replace()).
         ///If buffer size proves to be enough to fit the resultant string
@@ -2922,9 +4868,161 @@ struct select{
         ModifierTable const * modtab;
         SIZE_T last_replace_count;
         SIZE_T* last_replace_counter;
+        PCRE2_SIZE jit_stack_limit;
+        MatchLimits limits;
+        MatchContextHolder own_mcontext;
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        Deadline deadline;
+        #endif
+
+        //The limits to match with: these, then the ones of the Regex object.
+        MatchLimits matchLimits() const {
+            return re ? limits.over(re->limits) : limits;
+        }
+
+        //Passes the JIT stack limit, the match limits, the callout and the deadline that are set on to a MatchEvaluator.
+        void passLimits(MatchEvaluator& me) const {
+            me.setJitStackLimit(jit_stack_limit);
+            if(limits.match) me.setMatchLimit(limits.match);
+            if(limits.depth) me.setDepthLimit(limits.depth);
+            if(limits.heap) me.setHeapLimit(limits.heap);
+            if(limits.callout) me.setCallout(limits.callout, limits.callout_data);
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(deadline.isSet()) me.setDeadline(deadline.at).setTimeout(deadline.timeout).setCancelToken(deadline.token);
+            #endif
+        }
+
+        //The error number for a failed substitute: the deadline's if it stopped the match.
+        int matchError(int rc) const {
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if(rc == PCRE2_ERROR_CALLOUT && deadline.error) return deadline.error;
+            #endif
+            return rc;
+        }
+
+        #ifdef JPCRE2_USE_THREADS
+        ThreadPool* pool;
+        PCRE2_SIZE chunk_size;
+
+        bool chunkedReplace(String*);
+        #endif
+
+        SIZE_T replaceRange(String const*, String*, SIZE_T, int*) const;
+
+        #ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+        template<typename Visitor>
+        int substituteEach(PCRE2_SIZE, PCRE2_SIZE, MatchData*, std::vector<Pcre2Uchar>*, Visitor&, PCRE2_SIZE*,
+                           Uint utf_checked = 0) const;
+
+        //Visitor for substituteEach() to compute the length of the result of replace().
+        struct LengthCounter {
+            PCRE2_SIZE last;    //end of the previous match
+            PCRE2_SIZE length;
+            SIZE_T count;
+            bool gaps;          //whether the text between matches is in the output
+            void operator()(PCRE2_SIZE so, PCRE2_SIZE eo, Pcre2Uchar const*, PCRE2_SIZE len){
+                if(gaps) length += so - last;
+                length += len;
+                last = eo;
+                ++count;
+            }
+        };
+
+        //Visitor for substituteEach() to collect the replacements in a vector.
+        struct VecStrCollector {
+            VecStr* vec;
+            SIZE_T count;
+            void operator()(PCRE2_SIZE, PCRE2_SIZE, Pcre2Uchar const* repl, PCRE2_SIZE len){
+                vec->push_back(String((Char const*) repl, len));
+                ++count;
+            }
+        };
+
+        //Visitor for substituteEach() to pass the replacements to a sink, reusing one string.
+        template<typename Sink>
+        struct SinkCaller {
+            Sink* sink;
+            String str;
+            SIZE_T count;
+            void operator()(PCRE2_SIZE, PCRE2_SIZE, Pcre2Uchar const* repl, PCRE2_SIZE len){
+                str.assign((Char const*) repl, len);
+                (*sink)(static_cast<String const&>(str));
+                ++count;
+            }
+        };
+
+        //Passes each replacement to the visitor, which counts them.
+        template<typename Visitor>
+        SIZE_T extract(Visitor&);
+
+        //Visitor for substituteEach() to replace in-place in a single forward pass.
+        //subject[0, w) is the final output and subject[w, ...) is still the original text.
+        //Output that would overwrite text that is yet to be read goes to pending.
+        struct InPlaceWriter {
+            Char* s;            //subject
+            PCRE2_SIZE w;       //write position
+            PCRE2_SIZE last;    //end of the previous match
+            PCRE2_SIZE guard;   //code units before the end of a match the next search may look at
+            String pending;
+            PCRE2_SIZE pstart;  //start of the pending output in pending
+            SIZE_T count;
+
+            void flush(PCRE2_SIZE limit){
+                PCRE2_SIZE n = pending.size() - pstart;
+                if(limit <= w || n == 0) return;
+                if(n > limit - w) n = limit - w;
+                std::char_traits<Char>::copy(s + w, pending.data() + pstart, n);
+                w += n;
+                pstart += n;
+                if(pstart == pending.size()){
+                    pending.clear();
+                    pstart = 0;
+                } else if(pstart > pending.size() / 2){
+                    pending.erase(0, pstart);
+                    pstart = 0;
+                }
+            }
+
+            //write n code units from p (may be inside s after w) without going beyond limit
+            void write(Char const* p, PCRE2_SIZE n, PCRE2_SIZE limit){
+                if(pending.size() == pstart){
+                    if(p == s + w){ //already in place
+                        w += n;
+                        return;
+                    }
+                    PCRE2_SIZE k = limit > w ? limit - w : 0;
+                    if(k > n) k = n;
+                    std::char_traits<Char>::move(s + w, p, k);
+                    w += k;
+                    p += k;
+                    n -= k;
+                }
+                pending.append(p, n);
+            }
+
+            void operator()(PCRE2_SIZE so, PCRE2_SIZE eo, Pcre2Uchar const* repl, PCRE2_SIZE len){
+                PCRE2_SIZE limit = eo > guard ? eo - guard : 0;
+                write(s + last, so - last, limit);
+                write((Char const*) repl, len, limit);
+                flush(limit);
+                last = eo;
+                ++count;
+            }
+        };
+
+        int countLength(LengthCounter&);
+        bool replaceInPlace();
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        bool replaceEach(String*);
+        #endif
+        #endif
 
         void init_vars() {
             re = 0;
+            #ifdef JPCRE2_USE_THREADS
+            pool = 0;
+            chunk_size = JPCRE2_DEFAULT_CHUNK_SIZE;
+            #endif
             r_subject_ptr = &r_subject;
             r_replw_ptr = &r_replw;
             replace_opts = PCRE2_SUBSTITUTE_OVERFLOW_LENGTH;
@@ -2938,6 +5036,11 @@ struct select{
             modtab = 0;
             last_replace_count = 0;
             last_replace_counter = &last_replace_count;
+            jit_stack_limit = JPCRE2_DEFAULT_JIT_STACK_LIMIT;
+            limits = MatchLimits();
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            deadline = Deadline();
+            #endif
         }
 
         void onlyCopy(RegexReplace const &rr){
@@ -2964,6 +5067,15 @@ struct select{
             last_replace_count = rr.last_replace_count;
             last_replace_counter = (rr.last_replace_counter == &rr.last_replace_count) ? &last_replace_count
                                                                                        : rr.last_replace_counter;
+            jit_stack_limit = rr.jit_stack_limit;
+            limits = rr.limits;
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            deadline = rr.deadline;
+            #endif
+            #ifdef JPCRE2_USE_THREADS
+            pool = rr.pool;
+            chunk_size = rr.chunk_size;
+            #endif
         }
 
         void deepCopy(RegexReplace const &rr){
@@ -3095,7 +5207,7 @@ struct select{
         ///@return Last error message
         String getErrorMessage() const  {
             #ifdef JPCRE2_USE_MINIMUM_CXX_11
-            return select<Char, Map>::getErrorMessage(error_number, error_offset);
+            return select<Char, Map, Alloc>::getErrorMessage(error_number, error_offset);
             #else
             return select<Char>::getErrorMessage(error_number, error_offset);
             #endif
@@ -3117,7 +5229,7 @@ struct select{
         ///@return subject string
         ///@see RegexMatch::getSubject()
         String getSubject() const  {
-            return *r_subject_ptr;
+            return copyOf(*r_subject_ptr);
         }
 
         /// Get pointer to subject string
@@ -3371,6 +5483,196 @@ struct select{
             return *this;
         }
 
+        #ifdef JPCRE2_USE_THREADS
+        ///Set a thread pool to run a global replace on large subjects in parallel.
+        ///
+        ///Works the same way as RegexMatch::setThreadPool(): the subject is split into chunks at line
+        ///boundaries, the chunks are replaced on the pool and the results are joined in order. The result
+        ///is exactly the same as a sequential replace. Requires PCRE2 10.35 or later
+        ///(`PCRE2_SUBSTITUTE_REPLACEMENT_ONLY`), otherwise the replace is done sequentially.
+        ///It also applies to the match performed by nreplace(), replace() and preplace() with a MatchEvaluator,
+        ///the callback is still called on the calling thread.
+        ///
+        ///Replace is done sequentially if `PCRE2_SUBSTITUTE_OVERFLOW_LENGTH` is not set or
+        ///`PCRE2_SUBSTITUTE_REPLACEMENT_ONLY` or `PCRE2_SUBSTITUTE_MATCHED` is set. The match data
+        ///block set with setMatchDataBlock() is not used for a parallel replace.
+        ///
+        ///The pool is not owned by the RegexReplace object. Null pointer unsets it.
+        ///Not available if `JPCRE2_DISABLE_THREADS` is defined.
+        ///@param tp Pointer to a jpcre2::ThreadPool object.
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setThreadPool()
+        RegexReplace& setThreadPool(ThreadPool* tp){
+            pool = tp;
+            return *this;
+        }
+
+        ///Get the thread pool that was set with setThreadPool().
+        ///@return pointer to the thread pool (default: null).
+        ThreadPool* getThreadPool() const {
+            return pool;
+        }
+
+        ///Set the size (in code units) of the chunks a subject is split into for a parallel replace.
+        ///0 disables parallel replace. Default is `JPCRE2_DEFAULT_CHUNK_SIZE` (1048576).
+        ///@param n chunk size
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setChunkSize()
+        RegexReplace& setChunkSize(PCRE2_SIZE n){
+            chunk_size = n;
+            return *this;
+        }
+
+        ///Get the chunk size for parallel replace.
+        ///@return chunk size
+        PCRE2_SIZE getChunkSize() const {
+            return chunk_size;
+        }
+        #endif
+
+        ///Set the maximum size of the JIT stack for patterns that need more than the default.
+        ///A match that fails with `PCRE2_ERROR_JIT_STACKLIMIT` is retried with a JIT stack that grows as needed up to
+        ///`n` bytes. Default is `JPCRE2_DEFAULT_JIT_STACK_LIMIT` (1048576), 0 disables it.
+        ///@param n Maximum JIT stack size in bytes.
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setJitStackLimit()
+        RegexReplace& setJitStackLimit(PCRE2_SIZE n){
+            jit_stack_limit = n;
+            return *this;
+        }
+
+        ///Get the maximum JIT stack size.
+        ///@return JIT stack limit in bytes.
+        PCRE2_SIZE getJitStackLimit() const {
+            return jit_stack_limit;
+        }
+
+        ///Set the match limit (`pcre2_set_match_limit()`) for the matches done by the replace.
+        ///A limit that is not set (0) is taken from the Regex object (see Regex::setMatchLimit()).
+        ///@param n Match limit, 0 to unset.
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setMatchLimit()
+        RegexReplace& setMatchLimit(uint32_t n){
+            limits.match = n;
+            return *this;
+        }
+
+        ///Set the depth limit (`pcre2_set_depth_limit()`).
+        ///@param n Depth limit, 0 to unset.
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setDepthLimit()
+        RegexReplace& setDepthLimit(uint32_t n){
+            limits.depth = n;
+            return *this;
+        }
+
+        ///Set the heap limit in kibibytes (`pcre2_set_heap_limit()`).
+        ///@param n Heap limit in KiB, 0 to unset.
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setHeapLimit()
+        RegexReplace& setHeapLimit(uint32_t n){
+            limits.heap = n;
+            return *this;
+        }
+
+        ///Get the match limit set with setMatchLimit().
+        ///@return Match limit, 0 if not set.
+        uint32_t getMatchLimit() const {
+            return limits.match;
+        }
+
+        ///Get the depth limit set with setDepthLimit().
+        ///@return Depth limit, 0 if not set.
+        uint32_t getDepthLimit() const {
+            return limits.depth;
+        }
+
+        ///Get the heap limit set with setHeapLimit().
+        ///@return Heap limit in KiB, 0 if not set.
+        uint32_t getHeapLimit() const {
+            return limits.heap;
+        }
+
+        ///Set the callout function of the matches done by the replace (`pcre2_set_callout()`).
+        ///@param f Callout function, null to unset.
+        ///@param data Data passed to it.
+        ///@return Reference to the calling RegexReplace object.
+        ///@see RegexMatch::setCallout()
+        RegexReplace& setCallout(int (*f)(CalloutBlock*, void*), void* data = 0){
+            limits.callout = f;
+            limits.callout_data = data;
+            return *this;
+        }
+
+        ///Check whether the last error is a match that gave up on a limit (see RegexMatch::isLimitExceeded()).
+        ///The subject is returned unchanged in that case.
+        ///@return true if a limit was exceeded.
+        bool isLimitExceeded() const {
+            return isLimitError(error_number);
+        }
+
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        ///Set a deadline for the replace: a global replace stops when it's reached, the result has the replacements
+        ///done before it and the rest of the subject as is (see RegexMatch::setDeadline()).
+        ///
+        ///This is done by calling `pcre2_substitute()` for each match; if that's not possible (with
+        ///`PCRE2_SUBSTITUTE_REPLACEMENT_ONLY`, `PCRE2_SUBSTITUTE_MATCHED` or without
+        ///`PCRE2_SUBSTITUTE_OVERFLOW_LENGTH`), the subject is returned unchanged when it's reached.
+        ///replaceBatch() leaves the subjects it hasn't replaced when it's reached unchanged.
+        ///@param t Deadline, `std::chrono::steady_clock::time_point::max()` to unset.
+        ///@return Reference to the calling RegexReplace object.
+        RegexReplace& setDeadline(std::chrono::steady_clock::time_point t){
+            deadline.at = t;
+            return *this;
+        }
+
+        ///Set a timeout: a deadline that is this long after the start of each replace (see setDeadline()).
+        ///@param d Timeout, zero to unset.
+        ///@return Reference to the calling RegexReplace object.
+        RegexReplace& setTimeout(std::chrono::nanoseconds d){
+            deadline.timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(d);
+            return *this;
+        }
+
+        ///Set a token to stop the replace (or a replaceBatch()) from another thread (see jpcre2::CancelToken).
+        ///@param token Pointer to a cancel token, null to unset.
+        ///@return Reference to the calling RegexReplace object.
+        RegexReplace& setCancelToken(CancelToken const* token){
+            deadline.token = token;
+            return *this;
+        }
+
+        ///Get the deadline set with setDeadline().
+        ///@return deadline, `std::chrono::steady_clock::time_point::max()` if not set.
+        std::chrono::steady_clock::time_point getDeadline() const {
+            return deadline.at;
+        }
+
+        ///Get the timeout set with setTimeout().
+        ///@return timeout, zero if not set.
+        std::chrono::nanoseconds getTimeout() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.timeout);
+        }
+
+        ///Get the cancel token set with setCancelToken().
+        ///@return pointer to the cancel token.
+        CancelToken const* getCancelToken() const {
+            return deadline.token;
+        }
+
+        ///Check whether the last replace was stopped by the deadline or timeout.
+        ///@return true if it timed out.
+        bool isTimedOut() const {
+            return error_number == (int) ERROR::TIMEOUT;
+        }
+
+        ///Check whether the last replace was stopped by the cancel token.
+        ///@return true if it was cancelled.
+        bool isCancelled() const {
+            return error_number == (int) ERROR::CANCELLED;
+        }
+        #endif
+
         /// After a call to this function PCRE2 and JPCRE2 options will be properly set.
         /// This function does not initialize or re-initialize options.
         /// If you want to set options from scratch, initialize them to 0 before calling this function.
@@ -3457,12 +5759,106 @@ struct select{
         ///@return Replaced string
         String replace(void);
 
+        ///Dry run of replace().
+        ///
+        ///Returns the exact length of the string replace() would return (with the same settings) without creating it
+        ///and stores the number of replacements in the replace counter (see setReplaceCounter()).
+        ///Replacements are only sized with `PCRE2_SUBSTITUTE_OVERFLOW_LENGTH`, one match at a time,
+        ///thus no memory is allocated for the output. The length can be used to set the buffer size
+        ///(setBufferSize()) for a following replace() so that it needs only one call to pcre2_substitute().
+        ///
+        ///On error, the error number is set and the length of the subject is returned (replace() returns the subject on error).
+        ///It needs PCRE2 10.35 or later; with older versions or if `PCRE2_SUBSTITUTE_MATCHED` is set, it calls replace()
+        ///and returns the length of the result.
+        ///@return Length of the resultant string in code units.
+        PCRE2_SIZE replaceLength(void);
+
+        #ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+        ///Get the expanded replacement string of each match instead of the replaced subject.
+        ///
+        ///For each match (only the first one if `PCRE2_SUBSTITUTE_GLOBAL` is not set), the replacement string
+        ///is expanded (e.g `$2-$1`) with `PCRE2_SUBSTITUTE_REPLACEMENT_ONLY` and the result is appended to `vec`
+        ///(the vector is cleared first). The subject is scanned once and one output buffer is used for all the matches.
+        ///Other settings (options, start offset, match context etc..) are the same as for replace();
+        ///`PCRE2_SUBSTITUTE_MATCHED` is ignored.
+        ///
+        ///On error, the error number is set and `vec` contains the replacements of the matches before the error.
+        ///The number of replacements is stored in the replace counter (see setReplaceCounter()).
+        ///It needs PCRE2 10.35 or later.
+        ///@param vec Pointer to a vector for the replacements.
+        ///@return Number of replacements.
+        SIZE_T extractReplacements(VecStr* vec){
+            vec->clear();
+            VecStrCollector collector;
+            collector.vec = vec;
+            return extract(collector);
+        }
+
+        ///@overload
+        ///...
+        ///Instead of a vector, each replacement is passed to a sink: `sink(replacement)` is called with a `String const&`
+        ///for each match, in order. The same string object is reused for all the matches, copy it if it is needed later.
+        ///@param sink A function or a function object taking a `String const&`.
+        ///@return Number of replacements.
+        template<typename Sink>
+        SIZE_T extractReplacements(Sink& sink){
+            SinkCaller<Sink> caller;
+            caller.sink = &sink;
+            return extract(caller);
+        }
+        #endif
+
+        ///Replace each of the `n` strings starting at `subjects` and write the results into the strings starting at `results`.
+        ///
+        ///It is the same as calling replace() on each of the subjects with all other settings (replacement string, options,
+        ///start offset, match context etc..) taken from this object, except that one output buffer and one match data block
+        ///are used for all the subjects and the results are assigned into the existing strings, reusing their capacity.
+        ///The subject set with setSubject() and the match data block set with setMatchDataBlock() are not used.
+        ///`PCRE2_SUBSTITUTE_OVERFLOW_LENGTH` is always on and `PCRE2_SUBSTITUTE_MATCHED` is ignored.
+        ///
+        ///With a thread pool (see setThreadPool()), the subjects are divided among the threads of the pool,
+        ///each of them with its own buffer and match data block.
+        ///
+        ///If replace fails for a subject, its result is the subject itself (as with replace()) and the error of the first
+        ///subject that failed is available with getErrorNumber().
+        ///The total number of replacements is stored in the replace counter (see setReplaceCounter()).
+        ///@param subjects Pointer to the first subject.
+        ///@param n Number of subjects.
+        ///@param results Pointer to the first of `n` result strings. It can be the same as `subjects` to replace in-place.
+        ///@return Total number of replacements.
+        SIZE_T replaceBatch(String const* subjects, SIZE_T n, String* results);
+
+        ///@overload
+        ///...
+        ///`results` is resized to the size of `subjects`.
+        ///@param subjects Vector of subjects.
+        ///@param results Vector of results. It can be the same as `subjects` to replace in-place.
+        ///@return Total number of replacements.
+        SIZE_T replaceBatch(VecStr const& subjects, VecStr& results){
+            results.resize(subjects.size());
+            return subjects.empty() ? (*last_replace_counter = 0) : replaceBatch(&subjects[0], subjects.size(), &results[0]);
+        }
+
         /// Perl compatible replace method.
         /// Modifies subject string in-place and returns replace count.
         ///
-        /// The replacement is performed with `RegexReplace::replace()` which uses `pcre2_substitute()`.
+        /// With PCRE2 10.35 or later, when the result is not longer than the subject (masking, deleting etc..),
+        /// the replacement is done in place, thus no second buffer is needed: a dry run (see replaceLength())
+        /// sizes the result, then in a single forward pass each match is replaced with `pcre2_substitute()`
+        /// (`PCRE2_SUBSTITUTE_REPLACEMENT_ONLY`) and the result is written back into the subject. Output that can
+        /// not be written yet (a replacement longer than its match) is kept aside until there is room for it.
+        /// If the dry run fails, the subject is left unchanged, as with replace(). The second pass finds the same
+        /// matches, thus it can only fail if it runs out of memory; the subject then has the replacements done
+        /// before the error and the rest of it as it was.
+        ///
+        /// Otherwise (older PCRE2, a longer result, a thread pool, a deadline or match data is set,
+        /// `PCRE2_SUBSTITUTE_OVERFLOW_LENGTH` is not set or `PCRE2_SUBSTITUTE_REPLACEMENT_ONLY` or
+        /// `PCRE2_SUBSTITUTE_MATCHED` is set), the subject is assigned the result of `RegexReplace::replace()`.
         /// @return replace count
         SIZE_T preplace(void){
+            #ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+            if(replaceInPlace()) return *last_replace_counter;
+            #endif
             *r_subject_ptr = replace();
             return *last_replace_counter;
         }
@@ -3478,6 +5874,10 @@ struct select{
         /// @param me MatchEvaluator object.
         /// @return replace count
         SIZE_T preplace(MatchEvaluator me){
+            #ifdef JPCRE2_USE_THREADS
+            me.setThreadPool(pool).setChunkSize(chunk_size);
+            #endif
+            passLimits(me);
             *r_subject_ptr = me.setRegexObject(getRegexObject())
                                .setSubject(r_subject_ptr) //do not use method
                                .setFindAll((getPcre2Option() & PCRE2_SUBSTITUTE_GLOBAL)!=0)
@@ -3517,6 +5917,10 @@ struct select{
         ///@see MatchEvaluator
         ///@see MatchEvaluatorCallback
         String nreplace(MatchEvaluator me){
+            #ifdef JPCRE2_USE_THREADS
+            me.setThreadPool(pool).setChunkSize(chunk_size);
+            #endif
+            passLimits(me);
             return me.setRegexObject(getRegexObject())
                      .setSubject(getSubjectPointer())
                      .setFindAll((getPcre2Option() & PCRE2_SUBSTITUTE_GLOBAL)!=0)
@@ -3535,6 +5939,10 @@ struct select{
         ///@return resultant string.
         ///@see replace()
         String replace(MatchEvaluator me){
+            #ifdef JPCRE2_USE_THREADS
+            me.setThreadPool(pool).setChunkSize(chunk_size);
+            #endif
+            passLimits(me);
             return me.setRegexObject(getRegexObject())
                      .setSubject(getSubjectPointer())
                      .setFindAll((getPcre2Option() & PCRE2_SUBSTITUTE_GLOBAL)!=0)
@@ -3568,6 +5976,8 @@ struct select{
         friend class RegexMatch;
         friend class RegexReplace;
         friend class MatchEvaluator;
+        friend class RegexCache;
+        friend class MatchTable;
 
         String pat_str;
         String const *pat_str_ptr;
@@ -3575,9 +5985,46 @@ struct select{
         Uint compile_opts;
         Uint jpcre2_compile_opts;
         ModifierTable const * modtab;
+        RegexCache * cache;
 
         CompileContext *ccontext;
         std::vector<unsigned char> tabv;
+        Uint newline_opt; //set with setNewLine(), 0 for default
+        SIZE_T jit_threshold; //0 for JIT compile in compile()
+        #ifdef JPCRE2_USE_THREADS
+        ThreadPool* jit_pool;
+        #endif
+        MatchLimits limits; //defaults for RegexMatch and RegexReplace
+
+        //Compiled code with the character tables it points to and some pattern info,
+        //shared by the copies of a Regex. It is not changed once created (except for the deferred JIT
+        //compilation, which adds a JIT compiled copy), compile() creates a new one.
+        struct SharedCode {
+            Pcre2Code *code;
+            std::vector<unsigned char> tables;
+            Uint option_bits;   //PCRE2_INFO_ALLOPTIONS
+            Uint newline;       //PCRE2_INFO_NEWLINE
+            bool jit;           //code itself is JIT compiled
+            uint32_t groups;    //PCRE2_INFO_CAPTURECOUNT + 1
+            std::vector<std::pair<String, uint32_t> > names; //name table, sorted by name (see MatchTable)
+            SIZE_T jit_threshold; //JIT compile when the code is used this many times (see Regex::setJitThreshold())
+            SIZE_T id;          //unique for each compiled code, unlike its address which may be reused
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            std::atomic<SIZE_T> refs;
+            std::atomic<bool> jit_pending; //JIT compile after jit_threshold uses
+            std::atomic<SIZE_T> uses;
+            std::atomic<Pcre2Code*> jit_code; //JIT compiled copy of code, once it's ready
+            #else
+            Atomic<SIZE_T> refs;
+            Atomic<bool> jit_pending;
+            Atomic<SIZE_T> uses;
+            Atomic<Pcre2Code*> jit_code;
+            #endif
+            #ifdef JPCRE2_USE_THREADS
+            ThreadPool* jit_pool; //JIT compile on this pool instead of the thread that uses the code
+            #endif
+        };
+        SharedCode *shared; //code == shared->code
 
 
         void init_vars() {
@@ -3586,16 +6033,147 @@ struct select{
             error_number = 0;
             error_offset = 0;
             code = 0;
+            shared = 0;
             pat_str_ptr = &pat_str;
             ccontext = 0;
+            newline_opt = 0;
             modtab = 0;
+            cache = 0;
+            jit_threshold = 0;
+            #ifdef JPCRE2_USE_THREADS
+            jit_pool = 0;
+            #endif
+            limits = MatchLimits();
         }
 
+        static void releaseCode(SharedCode* sc){
+            if(--sc->refs == 0){
+                Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::code_free(sc->code);
+                Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::code_free(sc->jit_code);
+                delete sc;
+            }
+        }
+
+        //releases the shared code, it's freed with the last Regex using it.
         void freeRegexMemory(void) {
-            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::code_free(code);
+            if(shared) releaseCode(shared);
+            shared = 0;
             code = 0; //we may use it again
         }
 
+        //The code may be in use by other threads, thus a copy is JIT compiled and published when it's ready.
+        static void jitCompile(SharedCode* sc){
+            Pcre2Code* jc = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::code_copy(sc->code);
+            if(jc && Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_compile(jc, PCRE2_JIT_COMPLETE) == 0) sc->jit_code = jc;
+            else Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::code_free(jc); //matches go on without JIT
+        }
+
+        //Counts a use of the code and performs the deferred JIT compilation (see setJitThreshold() and deserialize())
+        //when the threshold is reached. Called before the code is used for a match.
+        void doPendingJit() const {
+            if(!shared || !shared->jit_pending) return;
+            if(++shared->uses < shared->jit_threshold) return;
+            if(!shared->jit_pending.exchange(false)) return; //another thread is doing it
+            #ifdef JPCRE2_USE_THREADS
+            if(shared->jit_pool) {
+                SharedCode* sc = shared;
+                ++sc->refs; //the task keeps the code alive
+                shared->jit_pool->post([sc]{ jitCompile(sc); releaseCode(sc); });
+                return;
+            }
+            #endif
+            jitCompile(shared);
+        }
+
+        //The code to match with: the JIT compiled copy if there's one.
+        Pcre2Code* matchCode() const {
+            if(!shared) return code;
+            Pcre2Code* jc = shared->jit_code;
+            return jc ? jc : code;
+        }
+
+        //The JIT compiled code to match with pcre2_jit_match() instead of pcre2_match(), or null if there's none
+        //or the options need pcre2_match(): anything other than these options (e.g PCRE2_ANCHORED or partial
+        //matching), or a UTF subject that hasn't been checked (pcre2_jit_match() doesn't check it).
+        Pcre2Code* jitMatchCode(Uint opts) const {
+            if(!shared || (opts & ~(PCRE2_NOTBOL | PCRE2_NOTEOL | PCRE2_NOTEMPTY | PCRE2_NOTEMPTY_ATSTART
+                                    | PCRE2_NO_UTF_CHECK))) return 0;
+            if((shared->option_bits & PCRE2_UTF) && !(opts & PCRE2_NO_UTF_CHECK)) return 0;
+            Pcre2Code* jc = shared->jit_code;
+            return jc ? jc : (shared->jit ? code : 0);
+        }
+
+        //Reads the group count and the name table of the code into sc.
+        static void indexNames(SharedCode* sc){
+            uint32_t capture_count = 0, namecount = 0, name_entry_size = 0;
+            Pcre2Sptr tabptr = 0;
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(sc->code, PCRE2_INFO_CAPTURECOUNT, &capture_count);
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(sc->code, PCRE2_INFO_NAMECOUNT, &namecount);
+            sc->groups = capture_count + 1;
+            sc->names.clear();
+            if(namecount == 0) return;
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(sc->code, PCRE2_INFO_NAMETABLE, &tabptr);
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(sc->code, PCRE2_INFO_NAMEENTRYSIZE, &name_entry_size);
+            sc->names.reserve(namecount);
+            for(uint32_t i = 0; i < namecount; ++i, tabptr += name_entry_size){
+                if(sizeof( Char_T ) * CHAR_BIT == 8)
+                    sc->names.push_back(std::make_pair(toString((Char*) (tabptr + 2)), (uint32_t)((tabptr[0] << 8) | tabptr[1])));
+                else
+                    sc->names.push_back(std::make_pair(toString((Char*) (tabptr + 1)), (uint32_t) tabptr[0]));
+            }
+            //PCRE2 sorts by code unit, which may not be the order of String
+            std::stable_sort(sc->names.begin(), sc->names.end(), nameLess);
+        }
+
+        static bool nameLess(std::pair<String, uint32_t> const& a, std::pair<String, uint32_t> const& b){
+            return a.first < b.first;
+        }
+
+        static SIZE_T nextCodeId(){
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            static std::atomic<SIZE_T> last(0);
+            #else
+            static Atomic<SIZE_T> last(0);
+            #endif
+            return ++last;
+        }
+
+        //Id of the code of re, 0 if it's not compiled.
+        static SIZE_T codeId(Regex const* re){
+            return (re && re->shared) ? re->shared->id : 0;
+        }
+
+        //Makes a SharedCode for newly compiled (or decoded) code.
+        void setCode(Pcre2Code* c, SharedCode* sc){
+            code = c;
+            sc->code = c;
+            sc->id = nextCodeId();
+            sc->option_bits = 0;
+            sc->newline = 0;
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(c, PCRE2_INFO_ALLOPTIONS, &sc->option_bits);
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(c, PCRE2_INFO_NEWLINE, &sc->newline);
+            size_t jit_size = 0;
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(c, PCRE2_INFO_JITSIZE, &jit_size);
+            sc->jit = jit_size != 0;
+            indexNames(sc);
+            sc->jit_pending = false;
+            sc->jit_threshold = 1;
+            sc->uses = 0;
+            sc->jit_code = 0;
+            #ifdef JPCRE2_USE_THREADS
+            sc->jit_pool = 0;
+            #endif
+            sc->refs = 1;
+            shared = sc;
+        }
+
+        void shareCode(Regex const &r){
+            if(r.shared) ++r.shared->refs; //before releasing ours, they may be the same
+            freeRegexMemory();
+            shared = r.shared;
+            code = r.code;
+        }
+
         void freeCompileContext(){
             Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_free(ccontext);
             ccontext = 0;
@@ -3611,6 +6189,13 @@ struct select{
             error_number = r.error_number;
             error_offset = r.error_offset;
             modtab = r.modtab;
+            cache = r.cache;
+            newline_opt = r.newline_opt;
+            jit_threshold = r.jit_threshold;
+            limits = r.limits;
+            #ifdef JPCRE2_USE_THREADS
+            jit_pool = r.jit_pool;
+            #endif
         }
 
         void deepCopy(Regex const &r) {
@@ -3626,11 +6211,8 @@ struct select{
             //if tabv is not empty and ccontext is ok (not null) set the table pointer to ccontext
             if(ccontext  && !tabv.empty()) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_character_tables(ccontext, &tabv[0]);
 
-            //table pointer must be updated in the compiled code itself, jit memory copy is not available.
-            //copy is not going to work, we need a recompile.
-            //as all vars are already copied, we can just call compile()
-            r.code ? compile() //compile frees previous memory.
-                   : freeRegexMemory();
+            //the compiled code (and the tables it points to) is immutable, share it instead of a recompile.
+            shareCode(r);
         }
 
         #ifdef JPCRE2_USE_MINIMUM_CXX_11
@@ -3651,10 +6233,71 @@ struct select{
             //steal the code
             freeRegexMemory();
             code = r.code; r.code = 0; //must set this to 0
+            shared = r.shared; r.shared = 0;
         }
 
         #endif
 
+        //Offset of the character next to the one at offset off.
+        //CRLF is stepped over as a whole when it's a valid newline, a whole character in UTF mode.
+        PCRE2_SIZE nextCharOffset(Pcre2Sptr subject, PCRE2_SIZE subject_length, PCRE2_SIZE off) const {
+            Uint option_bits = shared->option_bits;
+            Uint newline = shared->newline;
+            bool crlf_is_newline = newline == PCRE2_NEWLINE_ANY
+                                || newline == PCRE2_NEWLINE_CRLF
+                                || newline == PCRE2_NEWLINE_ANYCRLF;
+            PCRE2_SIZE next = off + 1; /* Advance one code unit */
+            if (crlf_is_newline &&                      /* If CRLF is newline & */
+                off < subject_length - 1 &&             /* we are at CRLF, */
+                subject[off] == '\r' && subject[off + 1] == '\n')
+                return next + 1;                        /* Advance by one more. */
+            if (option_bits & PCRE2_UTF) { /* advance a whole UTF (8 or 16), for UTF-32, it's not needed */
+                while (next < subject_length) {
+                    if(sizeof( Char_T ) * CHAR_BIT == 8 && (subject[next] & 0xc0) != 0x80) break;
+                    else if(sizeof( Char_T ) * CHAR_BIT == 16 && (subject[next] & 0xfc00) != 0xdc00) break;
+                    else if(sizeof( Char_T ) * CHAR_BIT == 32) break; //must be else if
+                    next += 1;
+                }
+            }
+            return next;
+        }
+
+        #ifdef JPCRE2_USE_THREADS
+        //Whether a global search with match options opts can be started from any offset of the subject
+        //and thus can be split into chunks. Anchored patterns, \G and partial matching can't.
+        bool isChunkable(Uint opts) const {
+            if(!code || (opts & (PCRE2_ANCHORED | PCRE2_PARTIAL_HARD | PCRE2_PARTIAL_SOFT))) return false;
+            if(shared->option_bits & PCRE2_ANCHORED) return false;
+            String const& pat = *pat_str_ptr;
+            for(SIZE_T i = 0; i + 1 < pat.size(); ++i){
+                if(pat[i] != '\\') continue;
+                if(pat[i+1] == 'G') return false;
+                ++i; //skip the escaped character
+            }
+            return true;
+        }
+
+        //Whether the subject is valid UTF from start_offset (the part pcre2_match() checks), or the pattern is
+        //not UTF. It is checked once for all the chunks, which are then searched with PCRE2_NO_UTF_CHECK.
+        bool checkUtf(Pcre2Sptr subject, PCRE2_SIZE length, PCRE2_SIZE start_offset) const {
+            if(!(shared->option_bits & PCRE2_UTF)) return true;
+            MatchData* md = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(code, getGeneralContext());
+            MatchContext* mc = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_context_create(getGeneralContext());
+            if(!md || !mc) {
+                Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+                Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_context_free(mc);
+                return false;
+            }
+            //the check is done before matching, which the match limit cuts short
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_match_limit(mc, 1);
+            int ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match(code, subject, length, start_offset,
+                                                                    PCRE2_ANCHORED | PCRE2_NO_JIT, md, mc);
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_context_free(mc);
+            return ret != PCRE2_ERROR_BADUTFOFFSET && !(ret <= PCRE2_ERROR_UTF8_ERR1 && ret >= PCRE2_ERROR_UTF32_ERR2);
+        }
+        #endif
+
         protected:
 
         int error_number;
@@ -3736,7 +6379,10 @@ struct select{
         /// @overload
         ///...
         /// Copy constructor.
-        /// A separate and new compile is performed from the copied options.
+        /// The compiled code (along with its JIT code and character tables) is not recompiled, it is
+        /// shared with the copied object. It is immutable (a compile() creates new code for the object
+        /// that calls it) and freed with the last object using it, thus copying is cheap and copies can
+        /// be used concurrently in different threads (with `>=C++11`, the reference count is atomic).
         ///
         /// @param r Constant Regex object reference.
         Regex(Regex const &r) {
@@ -3882,19 +6528,27 @@ struct select{
         /// to apply the new character tables.
         /// @return Reference to the calling Regex object.
         Regex& resetCharacterTables() {
+            #ifdef JPCRE2_HAVE_MAKETABLES_FREE
+            GeneralContext* gcontext = getGeneralContext();
+            const unsigned char* tables = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::maketables(gcontext);
+            tabv = std::vector<unsigned char>(tables, tables+1088);
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::maketables_free(gcontext, tables);
+            #else
             const unsigned char* tables = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::maketables(0); //must pass 0, we are using free() to free the tables.
             tabv = std::vector<unsigned char>(tables, tables+1088);
             ::free((void*)tables); //must free memory
+            #endif
             if(!ccontext)
-                ccontext = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_create(0);
+                ccontext = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_create(getGeneralContext());
             Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_character_tables(ccontext, &tabv[0]);
             return *this;
         }
 
         ///Get Pcre2 raw compiled code pointer.
+        ///If the JIT compilation was deferred (see setJitThreshold()) and is done, it's the JIT compiled copy.
         ///@return pointer to constant pcre2_code or null.
         Pcre2Code const* getPcre2Code() const{
-            return code;
+            return matchCode();
         }
 
         /// Get pattern string
@@ -3968,7 +6622,7 @@ struct select{
         ///@return Last error message
         String getErrorMessage() const  {
             #ifdef JPCRE2_USE_MINIMUM_CXX_11
-            return select<Char, Map>::getErrorMessage(error_number, error_offset);
+            return select<Char, Map, Alloc>::getErrorMessage(error_number, error_offset);
             #else
             return select<Char>::getErrorMessage(error_number, error_offset);
             #endif
@@ -4010,11 +6664,274 @@ struct select{
         ///@return Reference to the calling Regex object
         Regex& setNewLine(Uint value){
             if(!ccontext)
-                ccontext = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_create(0);
+                ccontext = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_create(getGeneralContext());
             int ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_newline(ccontext, value);
             if(ret < 0) error_number = ret;
+            else newline_opt = value;
+            return *this;
+        }
+
+        ///Set a cache for compiled code.
+        ///compile() will take the compiled code from the cache if the same pattern has been compiled
+        ///through it with the same options (PCRE2 and JPCRE2 options, new line convention and character tables),
+        ///otherwise it compiles the pattern and adds the code to the cache.
+        ///The cache must outlive this object (or be unset), but code taken from it lives as long as it's in use.
+        ///@param c Pointer to a RegexCache object, null to unset.
+        ///@return Reference to the calling Regex object
+        Regex& setCache(RegexCache* c){
+            cache = c;
+            return *this;
+        }
+
+        ///Get the cache that is set.
+        ///@return Pointer to RegexCache or null.
+        RegexCache* getCache() const {
+            return cache;
+        }
+
+        ///Defer the JIT compilation until the pattern has been used `n` times.
+        ///
+        ///This applies to patterns compiled with `jpcre2::JIT_COMPILE` (modifier 'S'). By default (`n = 0`) they are
+        ///JIT compiled by compile(). Otherwise they are matched without JIT until the compiled code (shared by the
+        ///copies of this object) has been used by `n` match or replace operations, then a JIT compiled copy of the code
+        ///is made and used by the following ones. Operations already running (in other threads) are not affected,
+        ///thus it's safe to use the code from many threads meanwhile. If JIT compilation fails, matches go on without JIT.
+        ///
+        ///Rarely used patterns thus cost nothing for JIT, while frequently used ones get JIT speed.
+        ///It takes effect on the next compile().
+        ///@param n Number of uses before JIT compilation, 0 to JIT compile in compile().
+        ///@return Reference to the calling Regex object
+        ///@see isJitCompiled()
+        Regex& setJitThreshold(SIZE_T n){
+            jit_threshold = n;
+            return *this;
+        }
+
+        ///Get the number of uses before JIT compilation.
+        ///@return JIT threshold.
+        ///@see setJitThreshold()
+        SIZE_T getJitThreshold() const {
+            return jit_threshold;
+        }
+
+        ///Set the default match limit for the matches and replaces done with this object.
+        ///It's used by the RegexMatch, RegexReplace and MatchEvaluator objects that don't set their own
+        ///(see RegexMatch::setMatchLimit()), thus a pattern can carry its own bound on how long a match can take.
+        ///@param n Match limit, 0 to unset.
+        ///@return Reference to the calling Regex object
+        Regex& setMatchLimit(uint32_t n){
+            limits.match = n;
+            return *this;
+        }
+
+        ///Set the default depth limit (see setMatchLimit() and RegexMatch::setDepthLimit()).
+        ///@param n Depth limit, 0 to unset.
+        ///@return Reference to the calling Regex object
+        Regex& setDepthLimit(uint32_t n){
+            limits.depth = n;
+            return *this;
+        }
+
+        ///Set the default heap limit in KiB (see setMatchLimit() and RegexMatch::setHeapLimit()).
+        ///@param n Heap limit in KiB, 0 to unset.
+        ///@return Reference to the calling Regex object
+        Regex& setHeapLimit(uint32_t n){
+            limits.heap = n;
+            return *this;
+        }
+
+        ///Get the default match limit.
+        ///@return Match limit, 0 if not set.
+        uint32_t getMatchLimit() const {
+            return limits.match;
+        }
+
+        ///Get the default depth limit.
+        ///@return Depth limit, 0 if not set.
+        uint32_t getDepthLimit() const {
+            return limits.depth;
+        }
+
+        ///Get the default heap limit.
+        ///@return Heap limit in KiB, 0 if not set.
+        uint32_t getHeapLimit() const {
+            return limits.heap;
+        }
+
+        #ifdef JPCRE2_USE_THREADS
+        ///Do the deferred JIT compilation (see setJitThreshold() and deserialize()) on a thread of `pool` instead of
+        ///the thread that reaches the threshold, so that no match waits for it.
+        ///The pool must outlive the compiled code (or be unset before compile()).
+        ///It takes effect on the next compile().
+        ///@param pool Pointer to a thread pool, null to unset.
+        ///@return Reference to the calling Regex object
+        Regex& setJitThreadPool(ThreadPool* pool){
+            jit_pool = pool;
             return *this;
         }
+        #endif
+
+        ///Check if the compiled code is JIT compiled (i.e matches use JIT).
+        ///@return true if matches use JIT compiled code.
+        bool isJitCompiled() const {
+            size_t size = 0;
+            Pcre2Code* c = matchCode();
+            if(c) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(c, PCRE2_INFO_JITSIZE, &size);
+            return size != 0;
+        }
+
+        ///Export compiled patterns to bytes, to be loaded with deserialize() without compiling them again.
+        ///
+        ///The compiled code is encoded with `pcre2_serialize_encode()` along with the pattern, PCRE2 and JPCRE2
+        ///compile options, new line convention, character tables and modifier tables of each Regex object.
+        ///Regex objects that are not compiled are exported without code. JIT code is not exported.
+        ///
+        ///As with PCRE2, the data can be loaded only by the same version of PCRE2 on the same architecture, and all
+        ///compiled patterns must use the same character tables (otherwise `PCRE2_ERROR_MIXEDTABLES` is returned).
+        ///@param regexes Regex objects to export.
+        ///@param bytes Byte vector to write to (it's cleared first).
+        ///@return 0 on success, otherwise a PCRE2 error number (bytes is empty).
+        static int serialize(std::vector<Regex> const& regexes, std::vector<unsigned char>& bytes);
+
+        ///Load Regex objects from bytes written by serialize(), without compiling them.
+        ///
+        ///The Regex objects have the same pattern, options, new line convention and character tables as the ones
+        ///exported. Patterns that were compiled with JIT (`jpcre2::JIT_COMPILE`) are JIT compiled on their first match
+        ///instead of here.
+        ///@param bytes Bytes written by serialize().
+        ///@param regexes Vector to put the Regex objects in (its content is replaced on success).
+        ///@param modtabs If not null, the modifier tables of the exported objects are put in this vector (its content is
+        ///replaced) and the Regex objects point to them, thus it must not be changed while they are in use.
+        ///Otherwise no modifier table is set.
+        ///@return 0 on success, otherwise a PCRE2 error number (`PCRE2_ERROR_BADSERIALIZEDDATA` for invalid data)
+        ///and the vectors are unchanged.
+        static int deserialize(std::vector<unsigned char> const& bytes, std::vector<Regex>& regexes,
+                               std::vector<ModifierTable>* modtabs = 0);
+
+        ///Same as serialize() but writes to a file.
+        ///@param regexes Regex objects to export.
+        ///@param path File path.
+        ///@return 0 on success, otherwise a PCRE2 error number or `jpcre2::ERROR::FILE_IO`.
+        static int serializeToFile(std::vector<Regex> const& regexes, char const* path){
+            std::vector<unsigned char> bytes;
+            int ret = serialize(regexes, bytes);
+            if(ret < 0) return ret;
+            std::FILE* f = std::fopen(path, "wb");
+            if(!f) return (int) ERROR::FILE_IO;
+            bool ok = std::fwrite(&bytes[0], 1, bytes.size(), f) == bytes.size();
+            if(std::fclose(f) != 0) ok = false;
+            return ok ? 0 : (int) ERROR::FILE_IO;
+        }
+
+        ///Same as deserialize() but reads from a file written by serializeToFile().
+        ///@param path File path.
+        ///@param regexes Vector to put the Regex objects in.
+        ///@param modtabs Vector to put the modifier tables in, or null.
+        ///@return 0 on success, otherwise a PCRE2 error number or `jpcre2::ERROR::FILE_IO`.
+        static int deserializeFromFile(char const* path, std::vector<Regex>& regexes,
+                                       std::vector<ModifierTable>* modtabs = 0){
+            std::FILE* f = std::fopen(path, "rb");
+            if(!f) return (int) ERROR::FILE_IO;
+            std::vector<unsigned char> bytes;
+            unsigned char buf[65536];
+            SIZE_T n;
+            while((n = std::fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+            bool ok = !std::ferror(f);
+            std::fclose(f);
+            return ok ? deserialize(bytes, regexes, modtabs) : (int) ERROR::FILE_IO;
+        }
+
+        ///Compile each of the Regex objects (see compile()).
+        ///
+        ///The pattern, modifier and other settings of each object must be set beforehand.
+        ///The error of each pattern is in its own object (see getErrorNumber(), getErrorMessage() and getErrorOffset()).
+        ///@param regexes Regex objects to compile.
+        ///@return Number of objects that could not be compiled.
+        static SIZE_T compileAll(std::vector<Regex>& regexes){
+            SIZE_T failed = 0;
+            for(SIZE_T i = 0; i < regexes.size(); ++i) {
+                regexes[i].compile();
+                if(!regexes[i].code) ++failed;
+            }
+            return failed;
+        }
+
+        ///@overload
+        ///...
+        ///`regexes` is resized to the size of `patterns` and each object is compiled with the corresponding pattern
+        ///and `mod`. Other settings of existing objects (modifier table, cache etc.) are kept.
+        ///@param patterns Vector of patterns.
+        ///@param mod Modifier string.
+        ///@param regexes Vector of Regex objects.
+        ///@return Number of patterns that could not be compiled.
+        static SIZE_T compileAll(VecStr const& patterns, Modifier const& mod, std::vector<Regex>& regexes){
+            regexes.resize(patterns.size());
+            for(SIZE_T i = 0; i < patterns.size(); ++i) regexes[i].setPattern(patterns[i]).setModifier(mod);
+            return compileAll(regexes);
+        }
+
+        #ifdef JPCRE2_USE_THREADS
+        ///@overload
+        ///...
+        ///The objects are compiled (and JIT compiled) by the threads of `pool`.
+        ///@param regexes Regex objects to compile.
+        ///@param pool Pointer to a thread pool. If null, this is the same as compileAll(std::vector<Regex>&).
+        ///@return Number of objects that could not be compiled.
+        static SIZE_T compileAll(std::vector<Regex>& regexes, ThreadPool* pool){
+            if(!pool) return compileAll(regexes);
+            pool->parallelFor(regexes.size(), [&regexes](SIZE_T i){ regexes[i].compile(); });
+            SIZE_T failed = 0;
+            for(SIZE_T i = 0; i < regexes.size(); ++i) if(!regexes[i].code) ++failed;
+            return failed;
+        }
+
+        ///@overload
+        ///@param patterns Vector of patterns.
+        ///@param mod Modifier string.
+        ///@param regexes Vector of Regex objects.
+        ///@param pool Pointer to a thread pool.
+        ///@return Number of patterns that could not be compiled.
+        static SIZE_T compileAll(VecStr const& patterns, Modifier const& mod, std::vector<Regex>& regexes, ThreadPool* pool){
+            regexes.resize(patterns.size());
+            for(SIZE_T i = 0; i < patterns.size(); ++i) regexes[i].setPattern(patterns[i]).setModifier(mod);
+            return compileAll(regexes, pool);
+        }
+
+        ///Compile the pattern (see compile()) on another thread and call `done` when it's finished.
+        ///
+        ///The object must not be used, changed or destroyed until then.
+        ///If the compile runs out of memory, the error number is `PCRE2_ERROR_NOMEMORY`.
+        ///@param pool Pointer to a thread pool to compile on. If null, a new (detached) thread is used.
+        ///@param done Callback, called with this object on the compiling thread.
+        ///Exceptions thrown by it are caught and ignored, there is no caller to pass them to.
+        void compileAsync(ThreadPool* pool, std::function<void(Regex&)> done){
+            Regex* self = this;
+            std::function<void()> task = [self, done]{
+                try {
+                    self->compile();
+                } catch(std::bad_alloc const&) {
+                    if(!self->code) self->error_number = PCRE2_ERROR_NOMEMORY;
+                }
+                if(!done) return;
+                try {
+                    done(*self);
+                } catch(...) {} //would terminate the program on this thread
+            };
+            if(pool) pool->post(std::move(task));
+            else std::thread(std::move(task)).detach();
+        }
+
+        ///@overload
+        ///...
+        ///@param pool Pointer to a thread pool to compile on. If null, a new (detached) thread is used.
+        ///@return A future that becomes ready with the error number (0 on success) when the compile is finished.
+        std::future<int> compileAsync(ThreadPool* pool = 0){
+            std::shared_ptr<std::promise<int> > p = std::make_shared<std::promise<int> >();
+            std::future<int> f = p->get_future();
+            compileAsync(pool, [p](Regex& re){ p->set_value(re.getErrorNumber()); });
+            return f;
+        }
+        #endif
 
         /// Set the pattern string to compile
         /// @param re Pattern string
@@ -4150,6 +7067,7 @@ struct select{
         }
 
         ///Compile pattern using info from class variables.
+        ///If a cache is set (see setCache()), the compiled code is taken from (or added to) the cache.
         ///@see Regex::compile(String const &re, Uint po, Uint jo)
         ///@see Regex::compile(String const &re, Uint po)
         ///@see Regex::compile(String const &re, Modifier mod)
@@ -4281,6 +7199,42 @@ struct select{
             return initMatch().setStartOffset(start_offset).setSubject(s).match();
         }
 
+        /// Perform a match and return its results as a value (see MatchResult), instead of filling vectors
+        /// set on a match object.
+        ///
+        /// The results keep a pointer to the subject, which must stay alive and unchanged while substrings
+        /// are taken from them. They don't depend on this Regex object.
+        /// @param s Subject string.
+        /// @param mod Modifier string (e.g `"g"` for all matches).
+        /// @param start_offset Offset from where matching will start in the subject string.
+        /// @return The matches, empty if none.
+        /// @see RegexMatch::match()
+        MatchResult search(String const &s, Modifier const& mod="", PCRE2_SIZE start_offset=0) const {
+            return search(&s, mod, start_offset);
+        }
+
+        ///@overload
+        ///...
+        /// @param s Pointer to subject string. A null pointer gives an empty result without a match
+        /// (the results could not point to the subject).
+        /// @param mod Modifier string.
+        /// @param start_offset Offset from where matching will start in the subject string.
+        /// @return The matches, empty if none.
+        MatchResult search(String const *s, Modifier const& mod="", PCRE2_SIZE start_offset=0) const {
+            MatchResult r;
+            if(!s) return r;
+            RegexMatch rm(this);
+            rm.setModifierTable(modtab).setStartOffset(start_offset).setSubject(s).setModifier(mod).setMatchTable(&r);
+            rm.match();
+            r.error_number = rm.getErrorNumber();
+            return r;
+        }
+
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        ///The results would point to a temporary subject: not allowed.
+        MatchResult search(String &&s, Modifier const& mod="", PCRE2_SIZE start_offset=0) const = delete;
+        #endif
+
         ///Returns a default constructed RegexReplace object by value.
         ///This object is initialized with the same modifier table as this Regex object.
         ///@return RegexReplace object.
@@ -4344,6 +7298,33 @@ struct select{
             return initReplace().setSubject(mains).setReplaceWith(repl).setModifier(mod).setReplaceCounter(counter).replace();
         }
 
+        /// Replace each of the subjects and write the results into `results`.
+        ///
+        /// It's a shorthand method to `RegexReplace::replaceBatch()`.
+        /// @param subjects Vector of subjects.
+        /// @param results Vector of results (resized to the size of `subjects`). It can be the same as `subjects`.
+        /// @param repl Replacement string (string to replace with).
+        /// @param mod Modifier string.
+        /// @return Total number of replacements.
+        SIZE_T replaceBatch(VecStr const& subjects, VecStr& results, String const& repl, Modifier const& mod=""){
+            return initReplace().setReplaceWith(repl).setModifier(mod).replaceBatch(subjects, results);
+        }
+
+        #ifdef JPCRE2_USE_THREADS
+        /// @overload
+        ///...
+        /// The subjects are divided among the threads of `pool`.
+        /// @param subjects Vector of subjects.
+        /// @param results Vector of results (resized to the size of `subjects`). It can be the same as `subjects`.
+        /// @param repl Replacement string (string to replace with).
+        /// @param mod Modifier string.
+        /// @param pool Pointer to a thread pool.
+        /// @return Total number of replacements.
+        SIZE_T replaceBatch(VecStr const& subjects, VecStr& results, String const& repl, Modifier const& mod, ThreadPool* pool){
+            return initReplace().setReplaceWith(repl).setModifier(mod).setThreadPool(pool).replaceBatch(subjects, results);
+        }
+        #endif
+
         /// Perl compatible replace method.
         /// Modifies subject string in-place and returns replace count.
         ///
@@ -4354,7 +7335,7 @@ struct select{
         /// @return replace count.
         SIZE_T preplace(String * mains, String const& repl, Modifier const& mod=""){
             SIZE_T counter = 0;
-            if(mains) *mains = initReplace().setSubject(mains).setReplaceWith(repl).setModifier(mod).setReplaceCounter(&counter).replace();
+            if(mains) initReplace().setSubject(mains).setReplaceWith(repl).setModifier(mod).setReplaceCounter(&counter).preplace();
             return counter;
         }
 
@@ -4370,7 +7351,7 @@ struct select{
         /// @return replace count.
         SIZE_T preplace(String * mains, String const* repl, Modifier const& mod=""){
             SIZE_T counter = 0;
-            if(mains) *mains = initReplace().setSubject(mains).setReplaceWith(repl).setModifier(mod).setReplaceCounter(&counter).replace();
+            if(mains) initReplace().setSubject(mains).setReplaceWith(repl).setModifier(mod).setReplaceCounter(&counter).preplace();
             return counter;
         }
 
@@ -4407,7 +7388,615 @@ struct select{
         }
     };
 
+    /** Cache for compiled code, shared by Regex objects.
+     * A Regex object with a cache set (Regex::setCache()) takes its compiled code from the cache
+     * when the same pattern has been compiled with the same options before, instead of compiling it again.
+     * Entries are keyed by pattern, PCRE2 and JPCRE2 compile options, new line convention, character tables
+     * and, for JIT compiled patterns, the JIT threshold and thread pool (see Regex::setJitThreshold())
+     * (the code unit width is that of the select class). The code is shared with the Regex objects,
+     * as with copies of a Regex (see Regex::Regex(Regex const&)).
+     *
+     * The least recently used entries are evicted when the memory used by the compiled code
+     * (including JIT code) exceeds the limit. The entries are divided into shards by the hash of their key,
+     * each with its own lock (with `>=C++11` and threads not disabled) and its own part of the memory limit,
+     * thus the cache can be used by many threads with little contention.
+     *
+     * ```cpp
+     * jp::RegexCache cache; //for example, a global one
+     * jp::Regex re;
+     * re.setCache(&cache).compile("\\d+", "i"); //compiled once
+     * ```
+     */
+    class RegexCache {
+
+        typedef typename Regex::SharedCode SharedCode;
+
+        struct Key {
+            String pattern;
+            Uint opts[3]; //PCRE2 options, JPCRE2 options, new line
+            std::vector<unsigned char> tables;
+            SIZE_T jit_threshold; //the code is JIT compiled by compile() or later, 0 without JIT
+            void const* jit_pool;
+            bool operator<(Key const& k) const {
+                for(int i = 0; i < 3; ++i)
+                    if(opts[i] != k.opts[i]) return opts[i] < k.opts[i];
+                if(jit_threshold != k.jit_threshold) return jit_threshold < k.jit_threshold;
+                if(jit_pool != k.jit_pool) return std::less<void const*>()(jit_pool, k.jit_pool);
+                if(pattern != k.pattern) return pattern < k.pattern;
+                return tables < k.tables;
+            }
+        };
+
+        struct Entry {
+            Key key;
+            SharedCode* code;
+            SIZE_T bytes;
+        };
+
+        typedef std::list<Entry> List;
+
+        struct Shard {
+            List lru; //most recently used first
+            std::map<Key, typename List::iterator> index;
+            SIZE_T bytes;
+            #ifdef JPCRE2_USE_THREADS
+            std::mutex mtx;
+            #endif
+        };
+
+        Shard* shards;
+        SIZE_T nshards;
+        SIZE_T shard_limit;
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        std::atomic<SIZE_T> hits, misses;
+        #else
+        SIZE_T hits, misses;
+        #endif
+
+        static void makeKey(Regex const& re, Key& key){
+            key.pattern = *re.pat_str_ptr;
+            key.opts[0] = re.compile_opts;
+            key.opts[1] = re.jpcre2_compile_opts;
+            key.opts[2] = re.newline_opt;
+            if(re.ccontext) key.tables = re.tabv;
+            bool jit = (re.jpcre2_compile_opts & JIT_COMPILE) != 0;
+            key.jit_threshold = jit ? re.jit_threshold : 0;
+            key.jit_pool = 0;
+            #ifdef JPCRE2_USE_THREADS
+            if(jit && re.jit_threshold) key.jit_pool = re.jit_pool;
+            #endif
+        }
+
+        Shard& shardOf(Key const& key){
+            //FNV-1a
+            SIZE_T h = 2166136261u;
+            for(SIZE_T i = 0; i < key.pattern.size(); ++i) h = (h ^ (SIZE_T) key.pattern[i]) * 16777619u;
+            for(int i = 0; i < 3; ++i) h = (h ^ key.opts[i]) * 16777619u;
+            h = (h ^ key.jit_threshold) * 16777619u;
+            return shards[h % nshards];
+        }
+
+        void evict(Shard& s){
+            while(s.bytes > shard_limit && !s.lru.empty()){
+                Entry& e = s.lru.back();
+                s.bytes -= e.bytes;
+                Regex::releaseCode(e.code);
+                s.index.erase(e.key);
+                s.lru.pop_back();
+            }
+        }
+
+        //Give re the cached code for its pattern and options, if any.
+        bool acquire(Regex& re);
+        //Add the code of re (just compiled) to the cache.
+        void insert(Regex const& re);
+
+        friend class Regex;
+
+        //not copyable
+        RegexCache(RegexCache const&);
+        RegexCache& operator=(RegexCache const&);
+
+        public:
+
+        ///Constructor.
+        ///@param max_bytes Memory limit for compiled code (including JIT code), defaults to `JPCRE2_DEFAULT_CACHE_SIZE`.
+        ///@param n Number of shards (at least 1).
+        explicit RegexCache(SIZE_T max_bytes = JPCRE2_DEFAULT_CACHE_SIZE, SIZE_T n = 16){
+            nshards = n ? n : 1;
+            shards = new Shard[nshards];
+            for(SIZE_T i = 0; i < nshards; ++i) shards[i].bytes = 0;
+            shard_limit = max_bytes / nshards;
+            hits = 0;
+            misses = 0;
+        }
+
+        ///Destructor.
+        ///Code in use by Regex objects is freed with the last one using it.
+        ~RegexCache(){
+            clear();
+            delete[] shards;
+        }
+
+        ///Remove all entries.
+        void clear(){
+            for(SIZE_T i = 0; i < nshards; ++i){
+                Shard& s = shards[i];
+                #ifdef JPCRE2_USE_THREADS
+                std::lock_guard<std::mutex> lock(s.mtx);
+                #endif
+                for(typename List::iterator it = s.lru.begin(); it != s.lru.end(); ++it) Regex::releaseCode(it->code);
+                s.lru.clear();
+                s.index.clear();
+                s.bytes = 0;
+            }
+        }
+
+        ///Get the number of entries.
+        ///@return Number of cached compiled patterns.
+        SIZE_T size(){
+            SIZE_T n = 0;
+            for(SIZE_T i = 0; i < nshards; ++i){
+                #ifdef JPCRE2_USE_THREADS
+                std::lock_guard<std::mutex> lock(shards[i].mtx);
+                #endif
+                n += shards[i].lru.size();
+            }
+            return n;
+        }
+
+        ///Get the memory used by the cached compiled code.
+        ///@return Size in bytes.
+        SIZE_T getMemory(){
+            SIZE_T n = 0;
+            for(SIZE_T i = 0; i < nshards; ++i){
+                #ifdef JPCRE2_USE_THREADS
+                std::lock_guard<std::mutex> lock(shards[i].mtx);
+                #endif
+                n += shards[i].bytes;
+            }
+            return n;
+        }
+
+        ///Get the number of compiles that took the code from the cache.
+        ///@return Number of cache hits.
+        SIZE_T getHits() const {
+            return hits;
+        }
+
+        ///Get the number of compiles that didn't find the code in the cache.
+        ///@return Number of cache misses.
+        SIZE_T getMisses() const {
+            return misses;
+        }
+    };
+
+    /** Describes a member of a struct `S` to be filled from a named group of a match
+     * (see MatchTable::parse(SIZE_T, S&, Field<S> const*, SIZE_T, int*) const).
+     *
+     * The converter takes the substring in the subject, without making a string. parseMember() makes one
+     * with jpcre2::parse() for a member; write your own with the same signature for other types
+     * (e.g timestamps), returning a jpcre2::PARSE result.
+     *
+     * ```cpp
+     * struct Metric { std::string host; long count; double value; };
+     * static jp::Field<Metric> const fields[] = {
+     *     {"host", jp::parseMember<Metric, std::string, &Metric::host>},
+     *     {"count", jp::parseMember<Metric, long, &Metric::count>},
+     *     {"value", jp::parseMember<Metric, double, &Metric::value>},
+     * };
+     * ```
+     */
+    template<typename S>
+    struct Field {
+        Char const* name;                                           ///< Group name
+        int (*parse)(Char const* first, Char const* last, S& obj);  ///< Converter of the substring
+    };
+
+    ///Converter of a Field for the member `M` of type `T` of `S`, with jpcre2::parse().
+    ///@param first Start of the substring.
+    ///@param last End of the substring.
+    ///@param obj The struct.
+    ///@return Result of jpcre2::parse().
+    template<typename S, typename T, T S::*M>
+    static int parseMember(Char const* first, Char const* last, S& obj){
+        return jpcre2::parse(first, last, obj.*M);
+    }
+
+    /** Match results stored as offsets: the start and end offsets of all groups of all matches
+     * in one array (match-major, group-minor), filled by RegexMatch::match() (see RegexMatch::setMatchTable()).
+     *
+     * A global match with many groups takes one growing array instead of a vector and a string per group and
+     * per match. Substrings are made on demand from the subject, which must be kept alive and unchanged while
+     * they are taken. Group names are looked up in the name table of the compiled code, which the table shares
+     * with the Regex objects (it stays valid if the Regex object is changed or destroyed).
+     *
+     * ```cpp
+     * jp::Regex re("(?<key>\\w+)=(?<value>\\w+)");
+     * jp::MatchTable table;
+     * jp::RegexMatch(&re).setSubject(&subject).setMatchTable(&table).setFindAll().match();
+     * for(size_t i = 0; i < table.size(); ++i)
+     *     std::cout<<table.get(i, "key")<<": "<<table.get(i, 2);
+     * ```
+     */
+    class MatchTable {
+
+        typedef typename Regex::SharedCode SharedCode;
+
+        friend class RegexMatch;
+
+        std::vector<PCRE2_SIZE> offsets; //start and end of each group of each match
+        uint32_t groups;            //groups per match, including group 0
+        SIZE_T count;
+        String const* subject;
+        SharedCode* code;           //for the names, one reference is held
+
+        void setCode(SharedCode* sc){
+            if(sc) ++sc->refs; //before releasing ours, they may be the same
+            if(code) Regex::releaseCode(code);
+            code = sc;
+        }
+
+        //Empties the table for the matches of re in s.
+        void start(Regex const* re, String const* s){
+            setCode(re->shared);
+            groups = code ? code->groups : 1;
+            subject = s;
+            offsets.clear();
+            count = 0;
+        }
+
+        //Adds a match: the first ovector pairs, missing ones are unset.
+        void push(PCRE2_SIZE const* ovector, uint32_t n){
+            if(n > groups) n = groups;
+            offsets.insert(offsets.end(), ovector, ovector + 2 * n);
+            offsets.resize(offsets.size() + 2 * (groups - n), PCRE2_UNSET);
+            ++count;
+        }
+
+        //Adds the matches of t (of the same pattern).
+        void append(MatchTable const& t){
+            offsets.insert(offsets.end(), t.offsets.begin(), t.offsets.end());
+            count += t.count;
+        }
+
+        PCRE2_SIZE const* at(SIZE_T m, uint32_t g) const {
+            return &offsets[2 * (m * groups + g)];
+        }
+
+        struct NameBefore {
+            bool operator()(std::pair<String, uint32_t> const& a, Char const* name) const {
+                return a.first.compare(name) < 0;
+            }
+        };
+
+        //Number of the first group named name that is set in match m, -1 if none.
+        int findSet(SIZE_T m, Char const* name) const {
+            if(!code) return -1;
+            typename std::vector<std::pair<String, uint32_t> >::const_iterator it =
+                std::lower_bound(code->names.begin(), code->names.end(), name, NameBefore());
+            for(; it != code->names.end() && it->first.compare(name) == 0; ++it)
+                if(isSet(m, it->second)) return (int) it->second;
+            return -1;
+        }
+
+        public:
+
+        ///Default constructor.
+        MatchTable():groups(1), count(0), subject(0), code(0){}
+
+        ///Copy constructor.
+        ///@param t MatchTable object
+        MatchTable(MatchTable const& t):offsets(t.offsets), groups(t.groups), count(t.count), subject(t.subject), code(0){
+            setCode(t.code);
+        }
+
+        ///Overloaded copy-assignment operator.
+        ///@param t MatchTable object
+        ///@return A reference to the calling MatchTable object.
+        MatchTable& operator=(MatchTable const& t){
+            if(this == &t) return *this;
+            offsets = t.offsets;
+            groups = t.groups;
+            count = t.count;
+            subject = t.subject;
+            setCode(t.code);
+            return *this;
+        }
+
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        ///Move constructor.
+        ///@param t rvalue reference to a MatchTable object
+        MatchTable(MatchTable&& t):offsets(std::move(t.offsets)), groups(t.groups), count(t.count), subject(t.subject), code(t.code){
+            t.code = 0;
+            t.clear();
+        }
+
+        ///Overloaded move-assignment operator.
+        ///@param t rvalue reference to a MatchTable object
+        ///@return A reference to the calling MatchTable object.
+        MatchTable& operator=(MatchTable&& t){
+            if(this == &t) return *this;
+            offsets = std::move(t.offsets);
+            groups = t.groups;
+            count = t.count;
+            subject = t.subject;
+            if(code) Regex::releaseCode(code);
+            code = t.code;
+            t.code = 0;
+            t.clear();
+            return *this;
+        }
+        #endif
+
+        ///Destructor.
+        ~MatchTable(){
+            if(code) Regex::releaseCode(code);
+        }
+
+        ///Remove all matches (the memory is kept for further use).
+        ///@return A reference to the calling MatchTable object.
+        MatchTable& clear(){
+            offsets.clear();
+            count = 0;
+            return *this;
+        }
+
+        ///Get the number of matches.
+        ///@return Number of matches.
+        SIZE_T size() const {
+            return count;
+        }
+
+        ///Check whether there are no matches.
+        ///@return true if empty.
+        bool empty() const {
+            return count == 0;
+        }
+
+        ///Get the number of groups in each match, including group 0 (the whole match).
+        ///@return Number of groups.
+        uint32_t getGroupCount() const {
+            return groups;
+        }
+
+        ///Get the subject the offsets refer to.
+        ///@return Pointer to the subject string of the match.
+        String const* getSubject() const {
+            return subject;
+        }
+
+        ///Get the offsets: `2 * getGroupCount()` values (start and end of each group) for each match.
+        ///@return Pointer to the offsets, PCRE2_UNSET for unset groups.
+        PCRE2_SIZE const* getOffsets() const {
+            return offsets.empty() ? 0 : &offsets[0];
+        }
+
+        ///Get the start offset of a group.
+        ///@param m Match index (`< size()`).
+        ///@param g Group number (`< getGroupCount()`), 0 for the whole match.
+        ///@return Start offset, PCRE2_UNSET if the group is unset.
+        PCRE2_SIZE getStartOffset(SIZE_T m, uint32_t g = 0) const {
+            return at(m, g)[0];
+        }
+
+        ///Get the end offset of a group.
+        ///@param m Match index (`< size()`).
+        ///@param g Group number (`< getGroupCount()`), 0 for the whole match.
+        ///@return End offset, PCRE2_UNSET if the group is unset.
+        PCRE2_SIZE getEndOffset(SIZE_T m, uint32_t g = 0) const {
+            return at(m, g)[1];
+        }
+
+        ///Check whether a group took part in a match.
+        ///@param m Match index (`< size()`).
+        ///@param g Group number (`< getGroupCount()`).
+        ///@return true if set.
+        bool isSet(SIZE_T m, uint32_t g) const {
+            return at(m, g)[0] != PCRE2_UNSET;
+        }
+
+        ///Get the number of a named group.
+        ///With duplicate names (`PCRE2_DUPNAMES`), the lowest number is returned.
+        ///@param name Group name.
+        ///@return Group number, -1 if there's no such group.
+        int getGroupNumber(String const& name) const {
+            if(!code) return -1;
+            typename std::vector<std::pair<String, uint32_t> >::const_iterator it =
+                std::lower_bound(code->names.begin(), code->names.end(), std::make_pair(name, (uint32_t) 0), Regex::nameLess);
+            return (it != code->names.end() && it->first == name) ? (int) it->second : -1;
+        }
+
+        ///Get the substring of a group.
+        ///@param m Match index (`< size()`).
+        ///@param g Group number (`< getGroupCount()`), 0 for the whole match.
+        ///@return Substring, empty if the group is unset.
+        String get(SIZE_T m, uint32_t g) const {
+            PCRE2_SIZE const* o = at(m, g);
+            if(o[0] == PCRE2_UNSET) return String();
+            return subject->substr(o[0], o[1] - o[0]);
+        }
+
+        ///@overload
+        ///...
+        ///With duplicate names, the substring of the first of them that is set.
+        ///@param m Match index (`< size()`).
+        ///@param name Group name.
+        ///@return Substring, empty if there's no such group or it's unset.
+        String get(SIZE_T m, String const& name) const {
+            if(!code) return String();
+            typename std::vector<std::pair<String, uint32_t> >::const_iterator it =
+                std::lower_bound(code->names.begin(), code->names.end(), std::make_pair(name, (uint32_t) 0), Regex::nameLess);
+            for(; it != code->names.end() && it->first == name; ++it)
+                if(isSet(m, it->second)) return get(m, it->second);
+            return String();
+        }
+
+        ///Convert the substring of a group to a value, without making a string.
+        ///
+        ///The substring is taken from the subject at the offsets of the group and converted with
+        ///jpcre2::parse(): integers, floating point numbers and strings.
+        ///@param m Match index (`< size()`).
+        ///@param g Group number, 0 for the whole match.
+        ///@param v Where the value is stored, unchanged on error.
+        ///@return jpcre2::PARSE::OK or the error (jpcre2::PARSE::UNSET if the group is unset or doesn't exist).
+        template<typename T>
+        int parse(SIZE_T m, uint32_t g, T& v) const {
+            if(g >= groups || !isSet(m, g)) return PARSE::UNSET;
+            PCRE2_SIZE const* o = at(m, g);
+            Char const* s = subject->data();
+            return jpcre2::parse(s + o[0], s + o[1], v);
+        }
+
+        ///@overload
+        ///...
+        ///With duplicate names, the first of them that is set.
+        ///@param m Match index (`< size()`).
+        ///@param name Group name.
+        ///@param v Where the value is stored, unchanged on error.
+        ///@return jpcre2::PARSE::OK or the error.
+        template<typename T>
+        int parse(SIZE_T m, String const& name, T& v) const {
+            int g = findSet(m, name.c_str());
+            return g < 0 ? (int) PARSE::UNSET : parse(m, (uint32_t) g, v);
+        }
+
+        ///@overload
+        ///...
+        ///Fill the members of a struct from the named groups of a match, as described by a Field table.
+        ///All fields are tried; those that fail are left unchanged.
+        ///@param m Match index (`< size()`).
+        ///@param obj The struct.
+        ///@param fields Array of field descriptors.
+        ///@param n Number of fields.
+        ///@param errors Array of `n` results (jpcre2::PARSE::OK or the error of each field), may be null.
+        ///@return Number of fields that failed, 0 if all were converted.
+        template<typename S>
+        SIZE_T parse(SIZE_T m, S& obj, Field<S> const* fields, SIZE_T n, int* errors = 0) const {
+            SIZE_T failed = 0;
+            Char const* s = subject ? subject->data() : 0;
+            for(SIZE_T i = 0; i < n; ++i){
+                int g = findSet(m, fields[i].name);
+                int r = PARSE::UNSET;
+                if(g >= 0){
+                    PCRE2_SIZE const* o = at(m, (uint32_t) g);
+                    r = fields[i].parse(s + o[0], s + o[1], obj);
+                }
+                if(r != PARSE::OK) ++failed;
+                if(errors) errors[i] = r;
+            }
+            return failed;
+        }
+    };
+
+    /** The results of a match as a value, returned by Regex::search().
+     *
+     * It's a MatchTable (one array with the offsets of all groups of all matches, a pointer to the subject and
+     * a shared reference to the compiled code for the names) with the error of the match: nothing is copied from
+     * the subject, and moving it moves one array. Group names and substrings are only looked up and made when
+     * they are asked for. It doesn't depend on the Regex object, which can be changed or destroyed; the subject
+     * must stay alive and unchanged while substrings are taken. Copies share the compiled code, they can be
+     * used on other threads (its reference count is atomic with `>= C++11`).
+     *
+     * ```cpp
+     * jp::MatchResult r = re.search(subject, "g");
+     * for(size_t i = 0; i < r.size(); ++i)
+     *     std::cout<<r.get(i, "key")<<r.getStartOffset(i, 2);
+     * ```
+     */
+    class MatchResult : public MatchTable {
+
+        friend class Regex;
+
+        int error_number;
+
+        public:
+
+        ///Default constructor: no match.
+        MatchResult():error_number(0){}
+
+        ///Check whether there is a match.
+        ///@return true if there's at least one match.
+        bool matched() const {
+            return !this->empty();
+        }
+
+        ///Get the error number of the match (see RegexMatch::getErrorNumber()).
+        ///The matches found before an error are kept.
+        ///@return Error number, 0 if there's none.
+        int getErrorNumber() const {
+            return error_number;
+        }
+
+        ///Get the error message of the match.
+        ///@return Error message, empty if there's no error.
+        String getErrorMessage() const {
+            return select::getErrorMessage(error_number, 0);
+        }
+    };
+
     private:
+
+    #ifdef JPCRE2_USE_THREADS
+    //A chunk of the subject for parallel match and replace.
+    struct Chunk {
+        PCRE2_SIZE from;        //where the search starts
+        PCRE2_SIZE stop;        //matches starting here or later belong to the next chunk
+        SIZE_T count;           //number of matches taken
+        int error;
+        PCRE2_SIZE first[2];    //offsets of the first match taken
+        PCRE2_SIZE next[2];     //offsets of the first match left to the next chunk (PCRE2_UNSET if none)
+    };
+
+    //Split [from, subject_length) into at most max_chunks chunks of at least chunk_size code units,
+    //each chunk (except the last) ending just after a newline.
+    static void makeChunks(Pcre2Sptr subject, PCRE2_SIZE from, PCRE2_SIZE subject_length,
+                           PCRE2_SIZE chunk_size, SIZE_T max_chunks, std::vector<Chunk>& chunks){
+        chunks.clear();
+        if(chunk_size == 0 || max_chunks < 2 || from >= subject_length) return;
+        PCRE2_SIZE n = (subject_length - from) / chunk_size;
+        if(n < 2) return;
+        if(n > max_chunks) n = max_chunks;
+        PCRE2_SIZE step = (subject_length - from) / n;
+        Chunk c;
+        c.from = from;
+        for(PCRE2_SIZE i = 1; i < n && c.from < subject_length; ++i){
+            PCRE2_SIZE cut = c.from + step;
+            while(cut < subject_length && subject[cut - 1] != '\n') ++cut;
+            if(cut >= subject_length) break;
+            c.stop = cut;
+            chunks.push_back(c);
+            c.from = cut;
+        }
+        c.stop = PCRE2_UNSET;
+        chunks.push_back(c);
+        if(chunks.size() < 2) chunks.clear();
+    }
+
+    //Run run(i) for each chunk on the pool, then verify that each chunk started where a sequential search
+    //would have continued from the previous chunk: its first match (taken or left) must be the one the
+    //previous chunk left to it. Matches found in a chunk are exactly the ones a sequential search would have
+    //found if the chunk passes this check. The first chunk that fails is dropped, and the previous chunk is
+    //searched again till the end of the subject on the calling thread.
+    //Returns the number of chunks to be used for the result.
+    template<typename Run>
+    static SIZE_T runChunks(ThreadPool& pool, std::vector<Chunk>& chunks, Run const& run){
+        pool.parallelFor(chunks.size(), run);
+        for(SIZE_T i = 1; i < chunks.size(); ++i){
+            Chunk& prev = chunks[i-1];
+            if(prev.error || prev.next[0] == PCRE2_UNSET) return i; //sequential search ends in prev
+            Chunk const& c = chunks[i];
+            PCRE2_SIZE const* first = c.count ? c.first : c.next;
+            if(first[0] != prev.next[0] || first[1] != prev.next[1]){
+                prev.stop = PCRE2_UNSET;
+                run(i-1);
+                return i;
+            }
+        }
+        return chunks.size();
+    }
+    #endif
+
     //prevent object instantiation of select class
     select();
     select(select const &);
@@ -4416,6 +8005,22 @@ struct select{
     #endif
     ~select();
 };//struct select
+
+#ifdef JPCRE2_USE_PMR
+/// @namespace jpcre2::pmr
+/// select with `std::pmr` containers (C++17).
+namespace pmr {
+///jpcre2::select with `std::pmr::polymorphic_allocator` strings and vectors and `std::pmr::map` maps.
+///Vectors you pass to a RegexMatch take the memory resource they were made with for the results
+///put in them, e.g:
+/// ```cpp
+/// std::pmr::monotonic_buffer_resource pool;
+/// jpcre2::pmr::select<char>::VecNum vec_num(&pool);
+/// ```
+template<typename Char_T>
+using select = jpcre2::select<Char_T, std::pmr::map, std::pmr::polymorphic_allocator<Char_T>>;
+}
+#endif
 }//jpcre2 namespace
 
 
@@ -4441,49 +8046,270 @@ inline void jpcre2::ModifierTable::parseModifierTable(std::string& tabjs, VecOpt
 
 
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-void jpcre2::select<Char_T, Map>::Regex::compile() {
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+void jpcre2::select<Char_T, Map, Alloc>::Regex::compile() {
+#else
+template<typename Char_T>
+void jpcre2::select<Char_T>::Regex::compile() {
+#endif
+    //Get c_str of pattern
+    Pcre2Sptr c_pattern = (Pcre2Sptr) pat_str_ptr->c_str();
+    int err_number = 0;
+    PCRE2_SIZE err_offset = 0;
+
+    /**************************************************************************
+     * Compile the regular expression pattern, and handle
+     * any errors that are detected.
+     *************************************************************************/
+
+    //first release any previous memory
+    freeRegexMemory();
+    if(cache && cache->acquire(*this)) return;
+    if(!ccontext && getGeneralContext()) //the code is allocated with the memory functions of the compile context
+        ccontext = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_create(getGeneralContext());
+    SharedCode* sc = new SharedCode();
+    //the code keeps a pointer to the tables, they must live as long as the (shared) code.
+    if(ccontext && !tabv.empty()) {
+        sc->tables = tabv;
+        Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_character_tables(ccontext, &sc->tables[0]);
+    }
+    code = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile(  c_pattern,              /* the pattern */
+                                    PCRE2_ZERO_TERMINATED,  /* indicates pattern is zero-terminated */
+                                    compile_opts,           /* default options */
+                                    &err_number,            /* for error number */
+                                    &err_offset,            /* for error offset */
+                                    ccontext);              /* use compile context */
+    if(ccontext && !tabv.empty()) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_character_tables(ccontext, &tabv[0]);
+
+    if (code == 0) {
+        /* Compilation failed */
+        //must not free regex memory, the only function has that right is the destructor
+        delete sc;
+        error_number = err_number;
+        error_offset = err_offset;
+        return;
+    }
+    int jit_ret = 0;
+    if ((jpcre2_compile_opts & JIT_COMPILE) != 0 && jit_threshold == 0) {
+        ///perform JIT compilation it it's enabled
+        jit_ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_compile(code, PCRE2_JIT_COMPLETE);
+        if(jit_ret < 0) error_number = jit_ret;
+    }
+    setCode(code, sc);
+    if ((jpcre2_compile_opts & JIT_COMPILE) != 0 && jit_threshold != 0) {
+        //JIT compile later, when it's used enough (see doPendingJit())
+        sc->jit_threshold = jit_threshold;
+        #ifdef JPCRE2_USE_THREADS
+        sc->jit_pool = jit_pool;
+        #endif
+        sc->jit_pending = true;
+    }
+    if(cache && jit_ret >= 0) cache->insert(*this);
+    //everything's OK
+}
+
+
+//magic bytes of the data written by Regex::serialize()
+#define JPCRE2_SERIAL_MAGIC "JPCRE2S1"
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+int jpcre2::select<Char_T, Map, Alloc>::Regex::serialize(std::vector<Regex> const& regexes, std::vector<unsigned char>& bytes) {
+#else
+template<typename Char_T>
+int jpcre2::select<Char_T>::Regex::serialize(std::vector<Regex> const& regexes, std::vector<unsigned char>& bytes) {
+#endif
+    bytes.clear();
+    ByteWriter out;
+    out.bytes = &bytes;
+    out.put(JPCRE2_SERIAL_MAGIC, 8);
+    out.putUint(sizeof( Char_T ) * CHAR_BIT);
+
+    //distinct modifier tables
+    std::vector<ModifierTable const*> tabs;
+    std::map<ModifierTable const*, Uint> tab_index; //index + 1
+    for(SIZE_T i = 0; i < regexes.size(); ++i) {
+        ModifierTable const* t = regexes[i].modtab;
+        if(t && tab_index.find(t) == tab_index.end()) {
+            tabs.push_back(t);
+            tab_index[t] = (Uint) tabs.size();
+        }
+    }
+    out.putSize(tabs.size());
+    for(SIZE_T i = 0; i < tabs.size(); ++i) tabs[i]->serialize(out);
+
+    std::vector<Pcre2Code const*> codes;
+    out.putSize(regexes.size());
+    for(SIZE_T i = 0; i < regexes.size(); ++i) {
+        Regex const& r = regexes[i];
+        bool tables = r.ccontext && !r.tabv.empty();
+        out.putUint((r.code ? 1 : 0) | (tables ? 2 : 0));
+        out.putUint(r.compile_opts);
+        out.putUint(r.jpcre2_compile_opts);
+        out.putUint(r.newline_opt);
+        out.putUint(r.modtab ? tab_index[r.modtab] : 0);
+        out.putString(*r.pat_str_ptr);
+        if(tables) {
+            out.putSize(r.tabv.size());
+            out.put(&r.tabv[0], r.tabv.size());
+        }
+        if(r.code) codes.push_back(r.code);
+    }
+
+    uint8_t* blob = 0;
+    PCRE2_SIZE size = 0;
+    if(!codes.empty()) {
+        int32_t ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::serialize_encode(&codes[0], (int32_t) codes.size(),
+                                                                                  &blob, &size, getGeneralContext());
+        if(ret < 0) {
+            bytes.clear();
+            return ret;
+        }
+    }
+    out.putSize(size);
+    if(blob) {
+        out.put(blob, size);
+        Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::serialize_free(blob);
+    }
+    return 0;
+}
+
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+int jpcre2::select<Char_T, Map, Alloc>::Regex::deserialize(std::vector<unsigned char> const& bytes, std::vector<Regex>& regexes,
+                                                    std::vector<ModifierTable>* modtabs) {
+#else
+template<typename Char_T>
+int jpcre2::select<Char_T>::Regex::deserialize(std::vector<unsigned char> const& bytes, std::vector<Regex>& regexes,
+                                               std::vector<ModifierTable>* modtabs) {
+#endif
+    ByteReader in;
+    in.p = bytes.empty() ? 0 : &bytes[0];
+    in.end = in.p + bytes.size();
+    char magic[8];
+    Uint width = 0;
+    SIZE_T ntabs = 0, n = 0;
+    if(!in.get(magic, 8) || std::string(magic, 8) != JPCRE2_SERIAL_MAGIC
+       || !in.getUint(width) || width != sizeof( Char_T ) * CHAR_BIT
+       || !in.getSize(ntabs) || ntabs > in.left())
+        return PCRE2_ERROR_BADSERIALIZEDDATA;
+    std::vector<ModifierTable> tabs(ntabs);
+    for(SIZE_T i = 0; i < ntabs; ++i)
+        if(!tabs[i].deserialize(in)) return PCRE2_ERROR_BADSERIALIZEDDATA;
+
+    if(!in.getSize(n) || n > in.left()) return PCRE2_ERROR_BADSERIALIZEDDATA;
+    std::vector<Regex> res(n);
+    VecOpt tab_index(n);
+    std::vector<Regex*> compiled;
+    for(SIZE_T i = 0; i < n; ++i) {
+        Regex& r = res[i];
+        Uint flags, newline;
+        if(!in.getUint(flags) || !in.getUint(r.compile_opts) || !in.getUint(r.jpcre2_compile_opts)
+           || !in.getUint(newline) || !in.getUint(tab_index[i]) || tab_index[i] > ntabs
+           || !in.getString(r.pat_str))
+            return PCRE2_ERROR_BADSERIALIZEDDATA;
+        if(newline) r.setNewLine(newline);
+        if(flags & 2) {
+            SIZE_T size;
+            if(!in.getSize(size) || size == 0 || size > in.left()) return PCRE2_ERROR_BADSERIALIZEDDATA;
+            r.tabv.resize(size);
+            in.get(&r.tabv[0], size);
+            if(!r.ccontext) r.ccontext = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile_context_create(getGeneralContext());
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::set_character_tables(r.ccontext, &r.tabv[0]);
+        }
+        if(flags & 1) compiled.push_back(&r);
+    }
+
+    SIZE_T size;
+    if(!in.getSize(size) || size != in.left() || (size == 0) != compiled.empty())
+        return PCRE2_ERROR_BADSERIALIZEDDATA;
+    if(!compiled.empty()) {
+        std::vector<unsigned char> blob(in.p, in.end); //suitably aligned for pcre2_serialize_decode()
+        if(Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::serialize_get_number_of_codes(&blob[0]) != (int32_t) compiled.size())
+            return PCRE2_ERROR_BADSERIALIZEDDATA;
+        std::vector<Pcre2Code*> codes(compiled.size());
+        int32_t ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::serialize_decode(&codes[0], (int32_t) codes.size(),
+                                                                                  &blob[0], getGeneralContext());
+        if(ret < 0) return ret;
+        for(SIZE_T i = 0; i < compiled.size(); ++i) {
+            compiled[i]->setCode(codes[i], new SharedCode());
+            compiled[i]->shared->jit_pending = (compiled[i]->jpcre2_compile_opts & JIT_COMPILE) != 0;
+        }
+    }
+
+    if(modtabs) {
+        modtabs->swap(tabs);
+        for(SIZE_T i = 0; i < n; ++i)
+            if(tab_index[i]) res[i].modtab = &(*modtabs)[tab_index[i] - 1];
+    }
+    regexes.swap(res);
+    return 0;
+}
+
+#undef JPCRE2_SERIAL_MAGIC
+
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexCache::acquire(Regex& re) {
 #else
 template<typename Char_T>
-void jpcre2::select<Char_T>::Regex::compile() {
+bool jpcre2::select<Char_T>::RegexCache::acquire(Regex& re) {
 #endif
-    //Get c_str of pattern
-    Pcre2Sptr c_pattern = (Pcre2Sptr) pat_str_ptr->c_str();
-    int err_number = 0;
-    PCRE2_SIZE err_offset = 0;
-
-    /**************************************************************************
-     * Compile the regular expression pattern, and handle
-     * any errors that are detected.
-     *************************************************************************/
+    Key key;
+    makeKey(re, key);
+    Shard& s = shardOf(key);
+    #ifdef JPCRE2_USE_THREADS
+    std::lock_guard<std::mutex> lock(s.mtx);
+    #endif
+    typename std::map<Key, typename List::iterator>::iterator it = s.index.find(key);
+    if(it == s.index.end()) {
+        ++misses;
+        return false;
+    }
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    SharedCode* sc = it->second->code;
+    ++sc->refs;
+    re.freeRegexMemory();
+    re.shared = sc;
+    re.code = sc->code;
+    ++hits;
+    return true;
+}
 
-    //first release any previous memory
-    freeRegexMemory();
-    code = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::compile(  c_pattern,              /* the pattern */
-                                    PCRE2_ZERO_TERMINATED,  /* indicates pattern is zero-terminated */
-                                    compile_opts,           /* default options */
-                                    &err_number,            /* for error number */
-                                    &err_offset,            /* for error offset */
-                                    ccontext);              /* use compile context */
 
-    if (code == 0) {
-        /* Compilation failed */
-        //must not free regex memory, the only function has that right is the destructor
-        error_number = err_number;
-        error_offset = err_offset;
-        return;
-    } else if ((jpcre2_compile_opts & JIT_COMPILE) != 0) {
-        ///perform JIT compilation it it's enabled
-        int jit_ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::jit_compile(code, PCRE2_JIT_COMPLETE);
-        if(jit_ret < 0) error_number = jit_ret;
-    }
-    //everything's OK
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+void jpcre2::select<Char_T, Map, Alloc>::RegexCache::insert(Regex const& re) {
+#else
+template<typename Char_T>
+void jpcre2::select<Char_T>::RegexCache::insert(Regex const& re) {
+#endif
+    Entry e;
+    makeKey(re, e.key);
+    e.code = re.shared;
+    size_t size = 0, jit_size = 0;
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(e.code->code, PCRE2_INFO_SIZE, &size);
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(e.code->code, PCRE2_INFO_JITSIZE, &jit_size);
+    e.bytes = size + jit_size + e.code->tables.size();
+    if(e.bytes > shard_limit) return;
+    Shard& s = shardOf(e.key);
+    #ifdef JPCRE2_USE_THREADS
+    std::lock_guard<std::mutex> lock(s.mtx);
+    #endif
+    if(s.index.find(e.key) != s.index.end()) return; //added by another thread meanwhile
+    ++e.code->refs;
+    s.lru.push_front(e);
+    s.index[e.key] = s.lru.begin();
+    s.bytes += e.bytes;
+    evict(s);
 }
 
 
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-typename jpcre2::select<Char_T, Map>::String jpcre2::select<Char_T, Map>::MatchEvaluator::replace(bool do_match, Uint replace_opts, SIZE_T * counter) {
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+typename jpcre2::select<Char_T, Map, Alloc>::String jpcre2::select<Char_T, Map, Alloc>::MatchEvaluator::replace(bool do_match, Uint replace_opts, SIZE_T * counter) {
 #else
 template<typename Char_T>
 typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::replace(bool do_match, Uint replace_opts, SIZE_T * counter) {
@@ -4505,7 +8331,7 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::
     // if mcount is 0, return the subject string. (there's no need to worry about re)
     if(!mcount) return RegexMatch::getSubject();
     SIZE_T current_offset = 0; //needs to be zero, not start_offset, because it's from where unmatched parts will be copied.
-    String res, tmp;
+    String res(RegexMatch::getSubjectPointer()->get_allocator()), tmp;
 
     //A check, this check is not fullproof.
     SIZE_T last = vec_eoff.size();
@@ -4559,17 +8385,18 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::
         bool retry = true;
         int ret = 0;
         PCRE2_SIZE outlengthptr = 0;
+        PCRE2_SIZE buffer_length = outlengthptr; //outlengthptr is changed on error
         Pcre2Uchar* output_buffer = new Pcre2Uchar[outlengthptr + 1]();
 
         while (true) {
             ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::substitute(
-                        re->code,               /*Points to the compiled pattern*/
+                        re->matchCode(),        /*Points to the compiled pattern*/
                         subject,                /*Points to the subject string*/
                         subject_length,         /*Length of the subject string*/
                         0,                      /*Offset in the subject at which to start matching*/ //must be zero
                         replace_opts,           /*Option bits*/
                         RegexMatch::mdata,      /*Points to a match data block, or is NULL*/
-                        RegexMatch::mcontext,   /*Points to a match context, or is NULL*/
+                        RegexMatch::own_mcontext.context(RegexMatch::mcontext, RegexMatch::matchLimits()), /*Points to a match context, or is NULL*/
                         replace,                /*Points to the replacement string*/
                         replace_length,         /*Length of the replacement string*/
                         output_buffer,          /*Points to the output buffer*/
@@ -4585,8 +8412,14 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::
                     /// we will try once more with a new buffer size adjusted to the length of the resultant string.
                     delete[] output_buffer;
                     output_buffer = new Pcre2Uchar[outlengthptr + 1]();
+                    buffer_length = outlengthptr;
                     // Go and try to perform the substitute again
                     continue;
+                } else if (ret == PCRE2_ERROR_JIT_STACKLIMIT
+                           && RegexMatch::own_mcontext.grow(RegexMatch::mcontext, RegexMatch::matchLimits(),
+                                                            RegexMatch::jit_stack_limit)) {
+                    outlengthptr = buffer_length;
+                    continue; //again with a bigger JIT stack
                 } else {
                     RegexMatch::error_number = ret;
                     delete[] output_buffer;
@@ -4610,8 +8443,8 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::
 
 
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-typename jpcre2::select<Char_T, Map>::String jpcre2::select<Char_T, Map>::MatchEvaluator::nreplace(bool do_match, Uint jo, SIZE_T* counter){
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+typename jpcre2::select<Char_T, Map, Alloc>::String jpcre2::select<Char_T, Map, Alloc>::MatchEvaluator::nreplace(bool do_match, Uint jo, SIZE_T* counter){
 #else
 template<typename Char_T>
 typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::nreplace(bool do_match, Uint jo, SIZE_T* counter){
@@ -4622,7 +8455,7 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::
     // if mcount is 0, return the subject string. (there's no need to worry about re)
     if(!mcount) return RegexMatch::getSubject();
     SIZE_T current_offset = 0; //no need for worrying about start offset, it's handled by match and we get valid offsets out of it.
-    String res;
+    String res(RegexMatch::getSubjectPointer()->get_allocator());
 
     //A check, this check is not fullproof
     SIZE_T last = vec_eoff.size();
@@ -4673,8 +8506,8 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::MatchEvaluator::
 
 
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-typename jpcre2::select<Char_T, Map>::String jpcre2::select<Char_T, Map>::RegexReplace::replace() {
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+typename jpcre2::select<Char_T, Map, Alloc>::String jpcre2::select<Char_T, Map, Alloc>::RegexReplace::replace() {
 #else
 template<typename Char_T>
 typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::RegexReplace::replace() {
@@ -4683,26 +8516,50 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::RegexReplace::re
 
     // If re or re->code is null, return the subject string unmodified.
     if (!re || re->code == 0)
-        return *r_subject_ptr;
+        return getSubject();
+    re->doPendingJit();
+    MatchLimits limits = matchLimits();
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    if (deadline.isSet()) {
+        deadline.start();
+        limits.deadline = &deadline;
+    }
+    #endif
+
+    #ifdef JPCRE2_USE_THREADS
+    if (pool && (replace_opts & PCRE2_SUBSTITUTE_GLOBAL)) {
+        String result(r_subject_ptr->get_allocator());
+        if (chunkedReplace(&result))
+            return result;
+    }
+    #endif
+    #if defined(JPCRE2_USE_MINIMUM_CXX_11) && defined(PCRE2_SUBSTITUTE_REPLACEMENT_ONLY)
+    if (deadline.isSet()) {
+        String result(r_subject_ptr->get_allocator());
+        if (replaceEach(&result))
+            return result;
+    }
+    #endif
 
     Pcre2Sptr subject = (Pcre2Sptr) r_subject_ptr->c_str();
     PCRE2_SIZE subject_length = r_subject_ptr->length();
     Pcre2Sptr replace = (Pcre2Sptr) r_replw_ptr->c_str();
     PCRE2_SIZE replace_length = r_replw_ptr->length();
     PCRE2_SIZE outlengthptr = (PCRE2_SIZE) buffer_size;
+    PCRE2_SIZE buffer_length = outlengthptr; //outlengthptr is changed on error
     bool retry = true;
     int ret = 0;
     Pcre2Uchar* output_buffer = new Pcre2Uchar[outlengthptr + 1]();
 
     while (true) {
         ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::substitute(
-                    re->code,               /*Points to the compiled pattern*/
+                    re->matchCode(),        /*Points to the compiled pattern*/
                     subject,                /*Points to the subject string*/
                     subject_length,         /*Length of the subject string*/
                     _start_offset,          /*Offset in the subject at which to start matching*/
                     replace_opts,           /*Option bits*/
                     mdata,                  /*Points to a match data block, or is NULL*/
-                    mcontext,               /*Points to a match context, or is NULL*/
+                    own_mcontext.context(mcontext, limits), /*Points to a match context, or is NULL*/
                     replace,                /*Points to the replacement string*/
                     replace_length,         /*Length of the replacement string*/
                     output_buffer,          /*Points to the output buffer*/
@@ -4718,53 +8575,540 @@ typename jpcre2::select<Char_T>::String jpcre2::select<Char_T>::RegexReplace::re
                 /// we will try once more with a new buffer size adjusted to the length of the resultant string.
                 delete[] output_buffer;
                 output_buffer = new Pcre2Uchar[outlengthptr + 1]();
+                buffer_length = outlengthptr;
                 // Go and try to perform the substitute again
                 continue;
+            } else if (ret == PCRE2_ERROR_JIT_STACKLIMIT && own_mcontext.grow(mcontext, limits, jit_stack_limit)) {
+                outlengthptr = buffer_length;
+                continue; //again with a bigger JIT stack
             } else {
-                error_number = ret;
+                error_number = matchError(ret);
                 delete[] output_buffer;
-                return *r_subject_ptr;
+                return getSubject();
             }
         }
         //If everything's ok exit the loop
         break;
     }
     *last_replace_counter += ret;
-    String result = String((Char*) output_buffer,(Char*) (output_buffer + outlengthptr) );
+    String result((Char*) output_buffer, (Char*) (output_buffer + outlengthptr), r_subject_ptr->get_allocator());
     delete[] output_buffer;
     return result;
 }
 
 
+#ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+//Calls pcre2_substitute() for each match from offset 'from' in the same way its own global loop does and
+//passes the match offsets and the replacement to visit(start_offset, end_offset, replacement, length).
+//Only one match is taken if PCRE2_SUBSTITUTE_GLOBAL is not set. Matches starting at or after 'stop' are not
+//taken, the first such match is saved in 'next'. md must be created from the pattern, buf is grown as needed.
+//utf_checked is PCRE2_NO_UTF_CHECK if the caller has checked the subject and the replacement.
+//If buf is null, replacements are only sized (PCRE2_SUBSTITUTE_OVERFLOW_LENGTH) and visit gets a null replacement.
+//Returns 0 on success, the PCRE2 error code, or ERROR::TIMEOUT or ERROR::CANCELLED if the deadline (started
+//by the caller) stopped it after visiting the matches before it.
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+template<typename Visitor>
+int jpcre2::select<Char_T, Map, Alloc>::RegexReplace::substituteEach(PCRE2_SIZE from, PCRE2_SIZE stop, MatchData* md,
+                                std::vector<Pcre2Uchar>* buf, Visitor& visit, PCRE2_SIZE* next, Uint utf_checked) const {
+#else
+template<typename Char_T>
+template<typename Visitor>
+int jpcre2::select<Char_T>::RegexReplace::substituteEach(PCRE2_SIZE from, PCRE2_SIZE stop, MatchData* md,
+                                std::vector<Pcre2Uchar>* buf, Visitor& visit, PCRE2_SIZE* next, Uint utf_checked) const {
+#endif
+    re->doPendingJit();
+    Pcre2Sptr subject = (Pcre2Sptr) r_subject_ptr->c_str();
+    PCRE2_SIZE subject_length = r_subject_ptr->length();
+    Pcre2Sptr replace = (Pcre2Sptr) r_replw_ptr->c_str();
+    PCRE2_SIZE replace_length = r_replw_ptr->length();
+    bool global = (replace_opts & PCRE2_SUBSTITUTE_GLOBAL) != 0;
+    Uint opts = (replace_opts & ~PCRE2_SUBSTITUTE_GLOBAL)
+                | PCRE2_SUBSTITUTE_REPLACEMENT_ONLY | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH | utf_checked;
+    Uint empty_opts = 0; //set after an empty match, see RegexMatch::match()
+    PCRE2_SIZE start_offset = from;
+    next[0] = next[1] = PCRE2_UNSET;
+    Pcre2Uchar unit[1];
+    MatchContextHolder mch; //this call may run on more than one thread
+    MatchLimits limits = matchLimits();
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    Deadline dl = deadline;
+    if (dl.isSet()) limits.deadline = &dl;
+    #endif
+    if (buf && buf->empty()) buf->resize(replace_length + 1);
+
+    for (;;) {
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        if (limits.deadline && dl.expired()) return dl.error;
+        #endif
+        PCRE2_SIZE size = buf ? buf->size() : 1;
+        PCRE2_SIZE outlen = size;
+        int ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::substitute(re->matchCode(), subject, subject_length,
+                            start_offset, opts | empty_opts, md, mch.context(mcontext, limits), replace, replace_length,
+                            buf ? &(*buf)[0] : unit, &outlen);
+        if (ret == PCRE2_ERROR_JIT_STACKLIMIT && mch.grow(mcontext, limits, jit_stack_limit)) continue;
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        if (ret == PCRE2_ERROR_CALLOUT && dl.error) return dl.error;
+        #endif
+        if (ret == PCRE2_ERROR_NOMEMORY && outlen > size) { //outlen is the required length
+            if (buf) {
+                buf->resize(outlen);
+                continue;
+            }
+            ret = 1; //only the size was wanted, the match is in md.
+            outlen -= 1; //without the terminating zero
+        }
+        if (ret < 0) return ret;
+        opts |= PCRE2_NO_UTF_CHECK; //the subject and the replacement have been checked by the first call
+        if (ret == 0) { //no match
+            if (empty_opts == 0) break;
+            start_offset = re->nextCharOffset(subject, subject_length, start_offset);
+            empty_opts = 0;
+            continue;
+        }
+        PCRE2_SIZE* ovector = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::get_ovector_pointer(md);
+        if (ovector[0] >= stop) {
+            next[0] = ovector[0];
+            next[1] = ovector[1];
+            break;
+        }
+        visit(ovector[0], ovector[1], buf ? (Pcre2Uchar const*) &(*buf)[0] : 0, outlen);
+        if (!global) break;
+        if (ovector[0] == ovector[1]) {
+            if (ovector[0] == subject_length) break;
+            empty_opts = PCRE2_NOTEMPTY_ATSTART | PCRE2_ANCHORED;
+        } else empty_opts = 0;
+        start_offset = ovector[1];
+    }
+    return 0;
+}
+#endif
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+PCRE2_SIZE jpcre2::select<Char_T, Map, Alloc>::RegexReplace::replaceLength() {
+#else
+template<typename Char_T>
+PCRE2_SIZE jpcre2::select<Char_T>::RegexReplace::replaceLength() {
+#endif
+    *last_replace_counter = 0;
+    if (!re || re->code == 0)
+        return r_subject_ptr->length();
+#ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+    if ((replace_opts & PCRE2_SUBSTITUTE_MATCHED) == 0) {
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        if (deadline.isSet()) deadline.start();
+        #endif
+        LengthCounter counter;
+        int ret = countLength(counter);
+        if (ret != 0) {
+            error_number = ret;
+            return r_subject_ptr->length();
+        }
+        *last_replace_counter = counter.count;
+        return counter.length;
+    }
+#endif
+    return replace().length();
+}
+
+
+#ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+template<typename Visitor>
+jpcre2::SIZE_T jpcre2::select<Char_T, Map, Alloc>::RegexReplace::extract(Visitor& visit) {
+#else
+template<typename Char_T>
+template<typename Visitor>
+jpcre2::SIZE_T jpcre2::select<Char_T>::RegexReplace::extract(Visitor& visit) {
+#endif
+    *last_replace_counter = 0;
+    if (!re || re->code == 0) return 0;
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    if (deadline.isSet()) deadline.start();
+    #endif
+    visit.count = 0;
+    PCRE2_SIZE next[2];
+    std::vector<Pcre2Uchar> buf(buffer_size + 1);
+    MatchData* md = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
+    int ret = substituteEach(_start_offset, PCRE2_UNSET, md, &buf, visit, next);
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+    if (ret != 0) error_number = ret; //the replacements before a timeout are kept
+    *last_replace_counter = visit.count;
+    return visit.count;
+}
+
+
+//Sizes the result of replace() with substituteEach() into counter (see replaceLength()).
+//Returns the result of substituteEach(), the counter is complete if it's 0.
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+int jpcre2::select<Char_T, Map, Alloc>::RegexReplace::countLength(LengthCounter& counter) {
+#else
+template<typename Char_T>
+int jpcre2::select<Char_T>::RegexReplace::countLength(LengthCounter& counter) {
+#endif
+    counter.gaps = (replace_opts & PCRE2_SUBSTITUTE_REPLACEMENT_ONLY) == 0;
+    counter.last = _start_offset;
+    counter.length = counter.gaps ? _start_offset : 0; //text before start offset is copied as is
+    counter.count = 0;
+    PCRE2_SIZE next[2];
+    MatchData* md = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
+    int ret = substituteEach(_start_offset, PCRE2_UNSET, md, 0, counter, next);
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+    if (ret == 0 && counter.gaps) counter.length += r_subject_ptr->length() - counter.last;
+    return ret;
+}
+
+
+//Replaces the subject in-place with InPlaceWriter, once the result is known to fit in it.
+//Returns false (without doing anything) if it is not applicable.
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexReplace::replaceInPlace() {
+#else
+template<typename Char_T>
+bool jpcre2::select<Char_T>::RegexReplace::replaceInPlace() {
+#endif
+    if (!re || re->code == 0 || mdata || r_subject_ptr->empty()
+        || !(replace_opts & PCRE2_SUBSTITUTE_OVERFLOW_LENGTH)
+        || (replace_opts & (PCRE2_SUBSTITUTE_REPLACEMENT_ONLY | PCRE2_SUBSTITUTE_MATCHED)))
+        return false;
+    #ifdef JPCRE2_USE_THREADS
+    if (pool) return false;
+    #endif
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    if (deadline.isSet()) return false; //replace() keeps the replacements done before it
+    #endif
+    *last_replace_counter = 0;
+
+    //a dry run first: a result that is longer than the subject needs a second buffer anyway
+    LengthCounter counter;
+    int ret = countLength(counter);
+    if (ret != 0) {
+        error_number = ret; //the subject is left unchanged, as by replace()
+        return true;
+    }
+    if (counter.length > r_subject_ptr->length()) return false;
+    if (counter.count == 0) return true;
+
+    uint32_t lookbehind = 0;
+    Uint option_bits = 0;
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(re->code, PCRE2_INFO_MAXLOOKBEHIND, &lookbehind);
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(re->code, PCRE2_INFO_ALLOPTIONS, &option_bits);
+    //code units per character (UTF-8: 4, UTF-16: 2)
+    PCRE2_SIZE units = (option_bits & PCRE2_UTF) ? 4 / sizeof( Char_T ) : 1;
+    if (units == 0) units = 1;
+
+    InPlaceWriter writer;
+    writer.s = &(*r_subject_ptr)[0]; //before substituteEach() takes c_str()
+    writer.w = 0;
+    writer.last = 0;
+    //a search may look behind its start offset (lookbehind, \b, ^ after a CRLF)
+    writer.guard = (lookbehind + 2) * units;
+    writer.pstart = 0;
+    writer.count = 0;
+    PCRE2_SIZE next[2];
+    std::vector<Pcre2Uchar> buf;
+    MatchData* md = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
+    //the dry run has checked the subject and the replacement, and the text still to be searched is unchanged
+    ret = substituteEach(_start_offset, PCRE2_UNSET, md, &buf, writer, next, PCRE2_NO_UTF_CHECK);
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+    //on error (it can only be out of memory, the matches were all found by the dry run)
+    //the replacements done before it are kept
+    PCRE2_SIZE length = r_subject_ptr->length();
+    writer.write(writer.s + writer.last, length - writer.last, length); //rest of the subject
+    writer.flush(length);
+    r_subject_ptr->resize(writer.w);
+    r_subject_ptr->append(writer.pending, writer.pstart, String::npos);
+    *last_replace_counter = writer.count;
+    if (ret != 0) error_number = ret;
+    return true;
+}
+#endif
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+//Performs the replace with substituteEach() to keep the replacements done before the deadline.
+//Returns false (without doing anything) if it is not applicable.
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexReplace::replaceEach(String* result) {
+    if (!(replace_opts & PCRE2_SUBSTITUTE_OVERFLOW_LENGTH)
+        || (replace_opts & (PCRE2_SUBSTITUTE_REPLACEMENT_ONLY | PCRE2_SUBSTITUTE_MATCHED)))
+        return false;
+    Pcre2Sptr subject = (Pcre2Sptr) r_subject_ptr->c_str();
+    PCRE2_SIZE subject_length = r_subject_ptr->length();
+    PCRE2_SIZE last = _start_offset;
+    SIZE_T count = 0;
+    result->assign((Char const*) subject, _start_offset);
+    auto visit = [&](PCRE2_SIZE so, PCRE2_SIZE eo, Pcre2Uchar const* repl, PCRE2_SIZE len) {
+        result->append((Char const*) (subject + last), so - last);
+        result->append((Char const*) repl, len);
+        last = eo;
+        ++count;
+    };
+    PCRE2_SIZE next[2];
+    std::vector<Pcre2Uchar> buf(buffer_size + 1);
+    MatchData* md = mdata ? mdata : Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
+    int ret = substituteEach(_start_offset, PCRE2_UNSET, md, &buf, visit, next);
+    if (!mdata) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+    if (ret < 0) {
+        error_number = ret;
+        *result = *r_subject_ptr;
+        return true;
+    }
+    if (ret > 0) error_number = ret; //timed out
+    if (last < subject_length) result->append((Char const*) (subject + last), subject_length - last);
+    *last_replace_counter = count;
+    return true;
+}
+#endif
+
+
+//Replaces n subjects into results with one output buffer and match data block.
+//The first error is stored in *err.
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+jpcre2::SIZE_T jpcre2::select<Char_T, Map, Alloc>::RegexReplace::replaceRange(String const* subjects, String* results,
+                                                                        SIZE_T n, int* err) const {
+#else
+template<typename Char_T>
+jpcre2::SIZE_T jpcre2::select<Char_T>::RegexReplace::replaceRange(String const* subjects, String* results,
+                                                                   SIZE_T n, int* err) const {
+#endif
+    re->doPendingJit();
+    Pcre2Sptr replace = (Pcre2Sptr) r_replw_ptr->c_str();
+    PCRE2_SIZE replace_length = r_replw_ptr->length();
+    Uint opts = replace_opts | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH;
+    #ifdef PCRE2_SUBSTITUTE_MATCHED
+    opts &= ~PCRE2_SUBSTITUTE_MATCHED;
+    #endif
+    MatchData* md = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
+    std::vector<Pcre2Uchar> buf(buffer_size + 1);
+    MatchContextHolder mch; //one per call, it runs on a pool thread
+    MatchLimits limits = matchLimits();
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    Deadline dl = deadline;
+    if (dl.isSet()) limits.deadline = &dl;
+    #endif
+    SIZE_T count = 0;
+    for (SIZE_T i = 0; i < n; ++i) {
+        #ifdef JPCRE2_USE_MINIMUM_CXX_11
+        if (limits.deadline && dl.expired()) { //the rest are left as they are
+            if (*err == 0) *err = dl.error;
+            results[i] = subjects[i];
+            continue;
+        }
+        #endif
+        PCRE2_SIZE outlen;
+        int ret;
+        for (;;) {
+            outlen = buf.size();
+            ret = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::substitute(re->matchCode(), (Pcre2Sptr) subjects[i].c_str(),
+                            subjects[i].length(), _start_offset, opts, md, mch.context(mcontext, limits), replace, replace_length,
+                            &buf[0], &outlen);
+            if (ret == PCRE2_ERROR_JIT_STACKLIMIT && mch.grow(mcontext, limits, jit_stack_limit)) continue;
+            if (ret != PCRE2_ERROR_NOMEMORY || outlen <= buf.size()) break;
+            buf.resize(outlen); //outlen is the required length
+        }
+        if (ret < 0) {
+            #ifdef JPCRE2_USE_MINIMUM_CXX_11
+            if (ret == PCRE2_ERROR_CALLOUT && dl.error) ret = dl.error;
+            #endif
+            if (*err == 0) *err = ret;
+            results[i] = subjects[i];
+            continue;
+        }
+        count += ret;
+        results[i].assign((Char const*) &buf[0], outlen);
+    }
+    Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+    return count;
+}
+
+
+#ifdef JPCRE2_USE_MINIMUM_CXX_11
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+jpcre2::SIZE_T jpcre2::select<Char_T, Map, Alloc>::RegexReplace::replaceBatch(String const* subjects, SIZE_T n, String* results) {
+#else
+template<typename Char_T>
+jpcre2::SIZE_T jpcre2::select<Char_T>::RegexReplace::replaceBatch(String const* subjects, SIZE_T n, String* results) {
+#endif
+    *last_replace_counter = 0;
+    if (!re || re->code == 0) {
+        for (SIZE_T i = 0; i < n; ++i) results[i] = subjects[i];
+        return 0;
+    }
+    int err = 0;
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    if (deadline.isSet()) deadline.start();
+    #endif
+    #ifdef JPCRE2_USE_THREADS
+    if (pool && n > 1) {
+        //a few blocks per thread to even out uneven subjects
+        SIZE_T nblocks = 4 * (pool->size() + 1);
+        if (nblocks > n) nblocks = n;
+        SIZE_T per_block = (n + nblocks - 1) / nblocks;
+        nblocks = (n + per_block - 1) / per_block;
+        VecOff counts(nblocks);
+        std::vector<int> errs(nblocks);
+        pool->parallelFor(nblocks, [&](SIZE_T b) {
+            SIZE_T from = b * per_block;
+            SIZE_T len = (n - from < per_block) ? n - from : per_block;
+            counts[b] = replaceRange(subjects + from, results + from, len, &errs[b]);
+        });
+        for (SIZE_T b = 0; b < nblocks; ++b) {
+            *last_replace_counter += counts[b];
+            if (err == 0) err = errs[b];
+        }
+        if (err) error_number = err;
+        return *last_replace_counter;
+    }
+    #endif
+    *last_replace_counter = replaceRange(subjects, results, n, &err);
+    if (err) error_number = err;
+    return *last_replace_counter;
+}
+
+
+#ifdef JPCRE2_USE_THREADS
+//Performs a global replace in chunks on the thread pool.
+//Returns false (without doing anything) if the subject can not be split.
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexReplace::chunkedReplace(String* result) {
+#ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+    if (!(replace_opts & PCRE2_SUBSTITUTE_OVERFLOW_LENGTH)
+        || (replace_opts & (PCRE2_SUBSTITUTE_REPLACEMENT_ONLY | PCRE2_SUBSTITUTE_MATCHED))
+        || !re->isChunkable(replace_opts))
+        return false;
+    Pcre2Sptr subject = (Pcre2Sptr) r_subject_ptr->c_str();
+    PCRE2_SIZE subject_length = r_subject_ptr->length();
+    std::vector<Chunk> chunks;
+    makeChunks(subject, _start_offset, subject_length, chunk_size, 4 * (pool->size() + 1), chunks);
+    if (chunks.empty()) return false;
+    //checked once here instead of by the first search of each chunk (to the end of the subject)
+    if (!(replace_opts & PCRE2_NO_UTF_CHECK)
+        && (!re->checkUtf(subject, subject_length, _start_offset)
+            || !re->checkUtf((Pcre2Sptr) r_replw_ptr->c_str(), r_replw_ptr->length(), 0)))
+        return false; //the error is reported by the sequential replace
+
+    std::vector<String> outs(chunks.size());
+    VecOff ends(chunks.size()); //end of the part of the subject that is in outs[i]
+
+    //each chunk gets the replaced text from its start to its end or to the end of its last match.
+    auto run = [&](SIZE_T i) {
+        Chunk& c = chunks[i];
+        String& out = outs[i];
+        PCRE2_SIZE last = c.from;
+        out.clear();
+        c.count = 0;
+        auto visit = [&](PCRE2_SIZE so, PCRE2_SIZE eo, Pcre2Uchar const* repl, PCRE2_SIZE len) {
+            if (c.count++ == 0) {
+                c.first[0] = so;
+                c.first[1] = eo;
+            }
+            out.append((Char const*) (subject + last), so - last);
+            out.append((Char const*) repl, len);
+            last = eo;
+        };
+        MatchData* md = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
+        std::vector<Pcre2Uchar> buf;
+        c.error = substituteEach(c.from, c.stop, md, &buf, visit, c.next, PCRE2_NO_UTF_CHECK);
+        Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(md);
+        PCRE2_SIZE end = c.stop < subject_length ? c.stop : subject_length;
+        if (last < end) out.append((Char const*) (subject + last), end - last);
+        ends[i] = last < end ? end : last;
+    };
+    SIZE_T used = runChunks(*pool, chunks, run);
+
+    for (SIZE_T i = 0; i < used; ++i) {
+        if (chunks[i].error > 0) { //timed out: the chunks before it and its replacements are kept
+            error_number = chunks[i].error;
+            used = i + 1;
+            break;
+        }
+        if (chunks[i].error) {
+            error_number = chunks[i].error;
+            *result = *r_subject_ptr;
+            return true;
+        }
+    }
+    //a chunk may start inside the last match of the previous one, that part is skipped.
+    SIZE_T total = 0;
+    PCRE2_SIZE done = _start_offset;
+    result->assign((Char const*) subject, _start_offset);
+    for (SIZE_T i = 0; i < used; ++i) {
+        PCRE2_SIZE skip = done > chunks[i].from ? done - chunks[i].from : 0;
+        if (skip < outs[i].size()) result->append(outs[i], skip, String::npos);
+        if (ends[i] > done) done = ends[i];
+        total += chunks[i].count;
+    }
+    if (done < subject_length) result->append((Char const*) (subject + done), subject_length - done);
+    *last_replace_counter += total;
+    return true;
+#else
+    JPCRE2_UNUSED(result);
+    return false;
+#endif
+}
+#endif
+
+
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-bool jpcre2::select<Char_T, Map>::RegexMatch::getNumberedSubstrings(int rc, Pcre2Sptr subject, PCRE2_SIZE* ovector, uint32_t ovector_count) {
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexMatch::getNumberedSubstrings(int rc, Pcre2Sptr subject, PCRE2_SIZE* ovector, uint32_t ovector_count) {
 #else
 template<typename Char_T>
 bool jpcre2::select<Char_T>::RegexMatch::getNumberedSubstrings(int rc, Pcre2Sptr subject, PCRE2_SIZE* ovector, uint32_t ovector_count) {
 #endif
-    NumSub num_sub;
-    uint32_t rcu = rc;
-    num_sub.reserve(rcu); //we know exactly how many elements it will have.
+    JPCRE2_UNUSED(rc);
+    if (!proj_mask.empty() && proj_end < ovector_count) ovector_count = proj_end; //see addCaptureGroup()
+    if (avec_num) {
+        ArenaAllocator<ArenaString> alloc(&arena);
+        avec_num->push_back(ArenaNumSub(alloc));
+        ArenaNumSub& anum_sub = avec_num->back();
+        anum_sub.reserve(ovector_count);
+        for (uint32_t i = 0u; i < ovector_count; i++) {
+            if (ovector[2*i] != PCRE2_UNSET && isExtracted(i))
+                anum_sub.push_back(ArenaString((Char*)(subject + ovector[2*i]), ovector[2*i+1] - ovector[2*i], alloc));
+            else
+            #ifdef JPCRE2_UNSET_CAPTURES_NULL
+                anum_sub.push_back(std::nullopt);
+            #else
+                anum_sub.push_back(ArenaString(alloc));
+            #endif
+        }
+    }
+    if (!vec_num) return true;
+    vec_num->push_back(NumSub());
+    NumSub& num_sub = vec_num->back();
+    if (!spare_num.empty()) { //kept from the previous match (see setReuseResults())
+        num_sub.swap(spare_num.back());
+        spare_num.pop_back();
+    }
+    num_sub.resize(ovector_count);
     uint32_t i;
     for (i = 0u; i < ovector_count; i++) {
-        if (ovector[2*i] != PCRE2_UNSET)
-            num_sub.push_back(String((Char*)(subject + ovector[2*i]), ovector[2*i+1] - ovector[2*i]));
+        if (ovector[2*i] != PCRE2_UNSET && isExtracted(i))
+        #ifdef JPCRE2_UNSET_CAPTURES_NULL
+            (num_sub[i] ? *num_sub[i] : num_sub[i].emplace()).assign((Char*)(subject + ovector[2*i]), ovector[2*i+1] - ovector[2*i]);
+        #else
+            num_sub[i].assign((Char*)(subject + ovector[2*i]), ovector[2*i+1] - ovector[2*i]);
+        #endif
         else
         #ifdef JPCRE2_UNSET_CAPTURES_NULL
-            num_sub.push_back(std::nullopt);
+            num_sub[i] = std::nullopt;
         #else
-            num_sub.push_back(String());
+            num_sub[i].clear();
         #endif
     }
-    vec_num->push_back(num_sub); //this function shouldn't be called if this vector is null
     return true;
 }
 
 
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-bool jpcre2::select<Char_T, Map>::RegexMatch::getNamedSubstrings(int namecount, int name_entry_size,
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexMatch::getNamedSubstrings(int namecount, int name_entry_size,
                                                             Pcre2Sptr name_table,
                                                             Pcre2Sptr subject, PCRE2_SIZE* ovector ) {
 #else
@@ -4775,54 +9119,76 @@ bool jpcre2::select<Char_T>::RegexMatch::getNamedSubstrings(int namecount, int n
 #endif
     Pcre2Sptr tabptr = name_table;
     String key;
-    MapNas map_nas;
-    MapNtN map_ntn;
-    for (int i = 0; i < namecount; i++) {
+    //the maps are filled in place, those kept from the previous match have the same names (see setReuseResults())
+    if(vec_nas) {
+        vec_nas->push_back(MapNas());
+        if(!spare_nas.empty()) {
+            vec_nas->back().swap(spare_nas.back());
+            spare_nas.pop_back();
+        }
+    }
+    if(vec_ntn) {
+        vec_ntn->push_back(MapNtN());
+        if(!spare_ntn.empty()) {
+            vec_ntn->back().swap(spare_ntn.back());
+            spare_ntn.pop_back();
+        }
+    }
+    ArenaAllocator<ArenaString> alloc(&arena);
+    if(avec_nas) avec_nas->push_back(ArenaMapNas(std::less<ArenaString>(), alloc));
+    for (int i = 0; i < namecount; i++, tabptr += name_entry_size) {
         int n;
         if(sizeof( Char_T ) * CHAR_BIT == 8){
             n = (int)((tabptr[0] << 8) | tabptr[1]);
+            if(!isExtracted((uint32_t) n)) continue; //see addCaptureGroup()
             key = toString((Char*) (tabptr + 2));
         }
         else{
             n = (int)tabptr[0];
+            if(!isExtracted((uint32_t) n)) continue;
             key = toString((Char*) (tabptr + 1));
         }
-        //Use of tabptr is finished for this iteration, let's increment it now.
-        tabptr += name_entry_size;
-        String value((Char*)(subject + ovector[2*n]), ovector[2*n+1] - ovector[2*n]); //n, not i.
-        if(vec_nas) map_nas[key] = value;
-        if(vec_ntn) map_ntn[key] = n;
+        if(vec_nas) vec_nas->back()[key].assign((Char*)(subject + ovector[2*n]), ovector[2*n+1] - ovector[2*n]); //n, not i.
+        if(vec_ntn) vec_ntn->back()[key] = n;
+        if(avec_nas) avec_nas->back()[ArenaString(key.data(), key.size(), alloc)]
+                         = ArenaString((Char*)(subject + ovector[2*n]), ovector[2*n+1] - ovector[2*n], alloc);
     }
-    //push the maps into vectors:
-    if(vec_nas) vec_nas->push_back(map_nas);
-    if(vec_ntn) vec_ntn->push_back(map_ntn);
     return true;
 }
 
 
 #ifdef JPCRE2_USE_MINIMUM_CXX_11
-template<typename Char_T, template<typename...> class Map>
-jpcre2::SIZE_T jpcre2::select<Char_T, Map>::RegexMatch::match() {
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+jpcre2::SIZE_T jpcre2::select<Char_T, Map, Alloc>::RegexMatch::match() {
 #else
 template<typename Char_T>
 jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
 #endif
 
+    _next_match[0] = _next_match[1] = PCRE2_UNSET;
+
     // If re or re->code is null, return 0 as the match count
     if (!re || re->code == 0)
         return 0;
+    re->doPendingJit();
+    resolveCaptureGroups();
+    #ifdef JPCRE2_USE_MINIMUM_CXX_11
+    if (deadline.isSet()) deadline.start();
+    #endif
+
+    #ifdef JPCRE2_USE_THREADS
+    SIZE_T chunked_count = 0;
+    if (pool && (jpcre2_match_opts & FIND_ALL) && chunkedMatch(&chunked_count))
+        return chunked_count;
+    #endif
 
     Pcre2Sptr subject = (Pcre2Sptr) m_subject_ptr->c_str();
     Pcre2Sptr name_table = 0;
-    int crlf_is_newline = 0;
     int namecount = 0;
     int name_entry_size = 0;
     int rc = 0;
     uint32_t ovector_count = 0;
-    int utf = 0;
     SIZE_T count = 0;
-    Uint option_bits;
-    Uint newline = 0;
     PCRE2_SIZE *ovector = 0;
     SIZE_T subject_length = 0;
     MatchData *match_data = 0;
@@ -4830,28 +9196,21 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
     bool mdc = false; //mdata created.
 
 
-    if (vec_num) vec_num->clear();
-    if (vec_nas) vec_nas->clear();
-    if (vec_ntn) vec_ntn->clear();
-    if(vec_soff) vec_soff->clear();
-    if(vec_eoff) vec_eoff->clear();
+    clearResults();
+    if(table) table->start(re, m_subject_ptr);
+    obuf_count = 0;
+    obuf_truncated = obuf && re->shared->groups > obuf_groups;
 
 
     /* Using this function ensures that the block is exactly the right size for
      the number of capturing parentheses in the pattern. */
     if(mdata) match_data = mdata;
     else {
-        match_data = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, 0);
+        match_data = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_create_from_pattern(re->code, getGeneralContext());
         mdc = true;
     }
 
-    rc = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match(  re->code,       /* the compiled pattern */
-                                subject,        /* the subject string */
-                                subject_length, /* the length of the subject */
-                                _start_offset,  /* start at offset 'start_offset' in the subject */
-                                match_opts,     /* default options */
-                                match_data,     /* block for storing the result */
-                                mcontext);      /* use default match context */
+    rc = matchAt(subject, subject_length, _start_offset, match_opts | utf_checked, match_data);
 
     /* Matching failed: handle error cases */
 
@@ -4867,16 +9226,30 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
                  */
             default:;
         }
-        error_number = rc;
+        error_number = matchError(rc);
         return count;
     }
 
-    ++count; //Increment the counter
     /* Match succeded. Get a pointer to the output vector, where string offsets are
      stored. */
     ovector = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::get_ovector_pointer(match_data);
     ovector_count = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::get_ovector_count(match_data);
 
+    if (ovector[0] >= _stop_offset) { //belongs to the next chunk
+        _next_match[0] = ovector[0];
+        _next_match[1] = ovector[1];
+        if(mdc)
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(match_data);
+        return count;
+    }
+    if (obuf && obuf_matches == 0) { //no room for it
+        obuf_truncated = true;
+        if(mdc)
+            Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(match_data);
+        return count;
+    }
+    ++count; //Increment the counter
+
     /************************************************************************//*
      * We have found the first match within the subject string. If the output *
      * vector wasn't big enough, say so. Then output any substrings that were *
@@ -4895,15 +9268,17 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
     //match succeeded at offset ovector[0]
     if(vec_soff) vec_soff->push_back(ovector[0]);
     if(vec_eoff) vec_eoff->push_back(ovector[1]);
+    if(table) table->push(ovector, ovector_count);
+    if(obuf) pushOffsets(ovector, ovector_count);
 
     // Get numbered substrings if vec_num isn't null
-    if (vec_num) { //must do null check
+    if (vec_num || avec_num) { //must do null check
         if(!getNumberedSubstrings(rc, subject, ovector, ovector_count))
             return count;
     }
 
     //get named substrings if either vec_nas or vec_ntn is given.
-    if (vec_nas || vec_ntn) {
+    if (vec_nas || vec_ntn || avec_nas) {
         /* See if there are any named substrings, and if so, show them by name. First
          we have to extract the count of named parentheses from the pattern. */
 
@@ -4974,26 +9349,12 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
         return count; /* Exit the program. */
     }
 
-    /* Before running the loop, check for UTF-8 and whether CRLF is a valid newline
-     sequence. First, find the options with which the regex was compiled and extract
-     the UTF state. */
-
-    (void) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(re->code, PCRE2_INFO_ALLOPTIONS, &option_bits);
-    utf = ((option_bits & PCRE2_UTF) != 0);
-
-    /* Now find the newline convention and see whether CRLF is a valid newline
-     sequence. */
-
-    (void) Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::pattern_info(re->code, PCRE2_INFO_NEWLINE, &newline);
-    crlf_is_newline = newline == PCRE2_NEWLINE_ANY
-            || newline == PCRE2_NEWLINE_CRLF
-            || newline == PCRE2_NEWLINE_ANYCRLF;
-
     /** We got the first match. Now loop for second and subsequent matches. */
 
     for (;;) {
 
         Uint options = match_opts; /* Normally no options */
+        bool empty_retry = false;
         PCRE2_SIZE start_offset = ovector[1]; /* Start at end of previous match */
 
         /* If the previous match was for an empty string, we are finished if we are
@@ -5004,20 +9365,16 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
             if (ovector[0] == subject_length)
                 break;
             options |= PCRE2_NOTEMPTY_ATSTART | PCRE2_ANCHORED;
+            empty_retry = true;
         }
 
         /// Run the next matching operation */
 
-        rc = Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match(  re->code,       /* the compiled pattern */
-                                    subject,        /* the subject string */
-                                    subject_length, /* the length of the subject */
-                                    start_offset,   /* starting offset in the subject */
-                                    options,        /* options */
-                                    match_data,     /* block for storing the result */
-                                    mcontext);      /* use match context */
+        /* The first match has checked the rest of the subject for valid UTF */
+        rc = matchAt(subject, subject_length, start_offset, options | PCRE2_NO_UTF_CHECK, match_data);
 
-        /* This time, a result of NOMATCH isn't an error. If the value in "options"
-         is zero, it just means we have found all possible matches, so the loop ends.
+        /* This time, a result of NOMATCH isn't an error. If this was not a retry
+         after an empty match, it just means we have found all possible matches, so the loop ends.
          Otherwise, it means we have failed to find a non-empty-string match at a
          point where there was a previous empty-string match. In this case, we do what
          Perl does: advance the matching position by one character, and continue. We
@@ -5027,24 +9384,12 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
          There are two complications: (a) When CRLF is a valid newline sequence, and
          the current position is just before it, advance by an extra byte. (b)
          Otherwise we must ensure that we skip an entire UTF character if we are in
-         UTF mode. */
+         UTF mode. Regex::nextCharOffset() takes care of both. */
 
         if (rc == PCRE2_ERROR_NOMATCH) {
-            if (options == 0)
+            if (!empty_retry)
                 break;                          /* All matches found */
-            ovector[1] = start_offset + 1; /* Advance one code unit */
-            if (crlf_is_newline &&                      /* If CRLF is newline & */
-                start_offset < subject_length - 1 &&    /* we are at CRLF, */
-                subject[start_offset] == '\r' && subject[start_offset + 1] == '\n')
-                ovector[1] += 1;                        /* Advance by one more. */
-            else if (utf) { /* advance a whole UTF (8 or 16), for UTF-32, it's not needed */
-                while (ovector[1] < subject_length) {
-                    if(sizeof( Char_T ) * CHAR_BIT == 8 && (subject[ovector[1]] & 0xc0) != 0x80) break;
-                    else if(sizeof( Char_T ) * CHAR_BIT == 16 && (subject[ovector[1]] & 0xfc00) != 0xdc00) break;
-                    else if(sizeof( Char_T ) * CHAR_BIT == 32) break; //must be else if
-                    ovector[1] += 1;
-                }
-            }
+            ovector[1] = re->nextCharOffset(subject, subject_length, start_offset);
             continue; /* Go round the loop again */
         }
 
@@ -5054,10 +9399,21 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
             if(mdc)
                 Pcre2Func<sizeof( Char_T ) * CHAR_BIT>::match_data_free(match_data);
             // Must not free code. This function has no right to modify regex.
-            error_number = rc;
+            error_number = matchError(rc); //the matches found so far are kept
             return count;
         }
 
+        if (ovector[0] >= _stop_offset) { //belongs to the next chunk
+            _next_match[0] = ovector[0];
+            _next_match[1] = ovector[1];
+            break;
+        }
+
+        if (obuf && obuf_count == obuf_matches) { //no room for it
+            obuf_truncated = true;
+            break;
+        }
+
         /* match succeeded */
         ++count; //Increment the counter
 
@@ -5072,17 +9428,19 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
         //match succeded at ovector[0]
         if(vec_soff) vec_soff->push_back(ovector[0]);
         if(vec_eoff) vec_eoff->push_back(ovector[1]);
+        if(table) table->push(ovector, ovector_count);
+        if(obuf) pushOffsets(ovector, ovector_count);
 
         /* As before, get substrings stored in the output vector by number, and then
          also any named substrings. */
 
         // Get numbered substrings if vec_num isn't null
-        if (vec_num) { //must do null check
+        if (vec_num || avec_num) { //must do null check
             if(!getNumberedSubstrings(rc, subject, ovector, ovector_count))
                 return count;
         }
 
-        if (vec_nas || vec_ntn) {
+        if (vec_nas || vec_ntn || avec_nas) {
             //must call this whether we have named substrings or not:
             if(!getNamedSubstrings(namecount, name_entry_size, name_table, subject, ovector))
                 return count;
@@ -5095,6 +9453,93 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
     return count;
 }
 
+#ifdef JPCRE2_USE_THREADS
+//Performs a global match in chunks on the thread pool.
+//Returns false (without doing anything) if the subject can not be split.
+template<typename Char_T, template<typename...> class Map, typename Alloc>
+bool jpcre2::select<Char_T, Map, Alloc>::RegexMatch::chunkedMatch(SIZE_T* count) {
+    if (!re->isChunkable(match_opts)) return false;
+    if (avec_num || avec_nas) return false; //the arena is for one thread
+    if (obuf) return false; //the search stops when it's full
+    std::vector<Chunk> chunks;
+    makeChunks((Pcre2Sptr) m_subject_ptr->c_str(), _start_offset, m_subject_ptr->length(),
+               chunk_size, 4 * (pool->size() + 1), chunks);
+    if (chunks.empty()) return false;
+    //checked once here instead of by the first search of each chunk (to the end of the subject)
+    if (!(match_opts & PCRE2_NO_UTF_CHECK)
+        && !re->checkUtf((Pcre2Sptr) m_subject_ptr->c_str(), m_subject_ptr->length(), _start_offset))
+        return false; //the error is reported by the sequential match
+
+    struct Part {
+        VecNum num;
+        VecNas nas;
+        VecNtN ntn;
+        VecOff soff;
+        VecOff eoff;
+        MatchTable table;
+    };
+    std::vector<Part> parts(chunks.size());
+
+    //each chunk is searched by a plain RegexMatch object, stopping at the chunk end.
+    auto run = [&](SIZE_T i) {
+        Chunk& c = chunks[i];
+        Part& part = parts[i];
+        RegexMatch rm(re);
+        rm.m_subject_ptr = m_subject_ptr;
+        rm.match_opts = match_opts;
+        rm.utf_checked = PCRE2_NO_UTF_CHECK;
+        rm.jpcre2_match_opts = jpcre2_match_opts;
+        rm.mcontext = mcontext;
+        rm.jit_stack_limit = jit_stack_limit;
+        rm.limits = limits;
+        rm.deadline = deadline.running();
+        rm.proj_mask = proj_mask; //resolved
+        rm.proj_end = proj_end;
+        rm.proj_code = proj_code;
+        rm._start_offset = c.from;
+        rm._stop_offset = c.stop;
+        rm.vec_num = vec_num ? &part.num : 0;
+        rm.vec_nas = vec_nas ? &part.nas : 0;
+        rm.vec_ntn = vec_ntn ? &part.ntn : 0;
+        rm.vec_soff = &part.soff;
+        rm.vec_eoff = &part.eoff;
+        rm.table = table ? &part.table : 0;
+        c.count = rm.match();
+        c.error = rm.error_number;
+        if (c.count) {
+            c.first[0] = part.soff[0];
+            c.first[1] = part.eoff[0];
+        }
+        c.next[0] = rm._next_match[0];
+        c.next[1] = rm._next_match[1];
+    };
+    SIZE_T used = runChunks(*pool, chunks, run);
+
+    if (vec_num) vec_num->clear();
+    if (vec_nas) vec_nas->clear();
+    if (vec_ntn) vec_ntn->clear();
+    if (vec_soff) vec_soff->clear();
+    if (vec_eoff) vec_eoff->clear();
+    if (table) table->start(re, m_subject_ptr);
+    *count = 0;
+    for (SIZE_T i = 0; i < used; ++i) {
+        Part& part = parts[i];
+        *count += chunks[i].count;
+        if (vec_num) vec_num->insert(vec_num->end(), std::make_move_iterator(part.num.begin()), std::make_move_iterator(part.num.end()));
+        if (vec_nas) vec_nas->insert(vec_nas->end(), std::make_move_iterator(part.nas.begin()), std::make_move_iterator(part.nas.end()));
+        if (vec_ntn) vec_ntn->insert(vec_ntn->end(), std::make_move_iterator(part.ntn.begin()), std::make_move_iterator(part.ntn.end()));
+        if (vec_soff) vec_soff->insert(vec_soff->end(), part.soff.begin(), part.soff.end());
+        if (vec_eoff) vec_eoff->insert(vec_eoff->end(), part.eoff.begin(), part.eoff.end());
+        if (table) table->append(part.table);
+        if (chunks[i].error) { //like a sequential match, the matches after it are dropped
+            error_number = chunks[i].error;
+            break;
+        }
+    }
+    return true;
+}
+#endif
+
 #undef JPCRE2_VECTOR_DATA_ASSERT
 #undef JPCRE2_UNUSED
 #undef JPCRE2_USE_MINIMUM_CXX_11
@@ -5112,6 +9557,14 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
 #define JPCRE2_NDEBUG
 #endif
 
+#ifndef JPCRE2_DISABLE_THREADS
+#define JPCRE2_DISABLE_THREADS
+#endif
+
+#ifndef JPCRE2_USE_FLAT_MAP
+#define JPCRE2_USE_FLAT_MAP
+#endif
+
 
 ///@def JPCRE2_USE_FUNCTION_POINTER_CALLBACK
 ///Use function pointer in all cases for MatchEvaluatorCallback function.
@@ -5147,6 +9600,37 @@ jpcre2::SIZE_T jpcre2::select<Char_T>::RegexMatch::match() {
 ///Define to change the type of NumSub so that captures are recorded
 ///with std::optional. It is undefined by default. This feature requires C++17.
 
+
+///@def JPCRE2_USE_FLAT_MAP
+///Define before including jpcre2.hpp to use jpcre2::FlatMap instead of `std::map` for MapNas and MapNtN
+///(with `>= C++11`, as the default of the `Map` template parameter of jpcre2::select).
+
+
+///@def JPCRE2_DISABLE_THREADS
+///Define before including jpcre2.hpp to leave out jpcre2::ThreadPool and the parallel match and replace
+///(`setThreadPool()`), along with the `<thread>`, `<mutex>` etc.. headers they need.
+///They are not available for `< C++11` anyway.
+
+
+///@def JPCRE2_USE_THREADS
+///Defined by jpcre2.hpp when jpcre2::ThreadPool and parallel match and replace are available
+///i.e `>= C++11` is used and `JPCRE2_DISABLE_THREADS` is not defined.
+
+
+///@def JPCRE2_DEFAULT_CHUNK_SIZE
+///Default chunk size (in code units) for parallel match and replace (1048576).
+///Define it before including jpcre2.hpp to override it.
+
+
+///@def JPCRE2_DEFAULT_CACHE_SIZE
+///Default memory limit (in bytes) of a jpcre2::select::RegexCache (67108864).
+///Define it before including jpcre2.hpp to override it.
+
+
+///@def JPCRE2_DEFAULT_JIT_STACK_LIMIT
+///Default maximum JIT stack size (in bytes) to retry a match with after a JIT stack limit error (1048576).
+///Define it before including jpcre2.hpp to override it.
+
 #endif
 
 
@@ -0,0 +1,237 @@
+/**@file jpcre2_embed.cpp
+ *  Generates C++ source with precompiled patterns.
+ *
+ *  It compiles the patterns listed in a manifest file with JPCRE2 (8 bit code unit)
+ *  and writes a source file that holds the serialized code (see jpcre2::select::Regex::serialize())
+ *  as a constant array along with an accessor for each pattern, and a header that declares them.
+ *  Pattern and modifier errors are reported here (at build time) instead of at run time.
+ *
+ *  Usage:
+ *
+ *      jpcre2_embed [-n namespace] manifest output.hpp output.cpp
+ *
+ *  Each line of the manifest is: name, modifier and pattern separated by tabs
+ *  (the pattern is the rest of the line). Empty lines and lines starting with `#` are ignored.
+ *  Names must be C++ identifiers other than keywords, `all`, `jp`, `detail` and `load`.
+ *
+ *      # name    modifier    pattern
+ *      date    S    (?<y>\d{4})-(?<m>\d\d)-(?<d>\d\d)
+ *      word    i    \w+
+ *
+ *  The generated source file must be compiled and linked with the program (once).
+ *  The generated header declares (in the given namespace, `patterns` by default):
+ *
+ *      jp::Regex date();                          //a copy that shares the compiled code
+ *      std::vector<jp::Regex> const& all();       //all patterns in manifest order
+ *
+ *  The code is loaded on first use. If it can't be loaded (e.g a different PCRE2 version),
+ *  the patterns are compiled instead.
+ *
+ * @include jpcre2_embed.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cctype>
+#include <cstdio>
+#include <set>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+struct Entry {
+    std::string name;
+    std::string modifier;
+    std::string pattern;
+};
+
+//C++ keywords (and alternative tokens) and the names the generated code uses itself.
+static char const* const reserved[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+    "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval", "constexpr",
+    "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+    "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+    "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+    "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+    "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+    "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+    "all", "jp", "detail", "load",
+};
+
+static bool isIdentifier(std::string const& s){
+    if(s.empty() || !(std::isalpha((unsigned char) s[0]) || s[0] == '_')) return false;
+    for(size_t i = 1; i < s.size(); ++i)
+        if(!(std::isalnum((unsigned char) s[i]) || s[i] == '_')) return false;
+    for(size_t i = 0; i < sizeof(reserved)/sizeof(reserved[0]); ++i)
+        if(s == reserved[i]) return false;
+    return true;
+}
+
+//C++ string literal, non printable characters (and the ones that can start a trigraph) are escaped in octal.
+static std::string literal(std::string const& s){
+    std::string r = "\"";
+    for(size_t i = 0; i < s.size(); ++i){
+        unsigned char c = (unsigned char) s[i];
+        if(c == '"' || c == '\\') {
+            r += '\\';
+            r += (char) c;
+        } else if(c < 32 || c > 126 || c == '?') {
+            char buf[8];
+            std::sprintf(buf, "\\%03o", c);
+            r += buf;
+        } else r += (char) c;
+    }
+    return r + "\"";
+}
+
+static bool readManifest(char const* path, std::vector<Entry>& entries){
+    std::FILE* f = std::fopen(path, "rb");
+    if(!f) {
+        std::fprintf(stderr, "%s: can not open file\n", path);
+        return false;
+    }
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    std::fclose(f);
+
+    bool ok = true;
+    std::set<std::string> names;
+    size_t pos = 0;
+    for(size_t line = 1; pos < text.size(); ++line){
+        size_t end = text.find('\n', pos);
+        if(end == std::string::npos) end = text.size();
+        std::string l = text.substr(pos, end - pos);
+        pos = end + 1;
+        if(!l.empty() && l[l.size() - 1] == '\r') l.erase(l.size() - 1);
+        if(l.empty() || l[0] == '#') continue;
+        size_t t1 = l.find('\t');
+        size_t t2 = (t1 == std::string::npos) ? t1 : l.find('\t', t1 + 1);
+        if(t2 == std::string::npos) {
+            std::fprintf(stderr, "%s:%lu: expected name, modifier and pattern separated by tabs\n", path, (unsigned long) line);
+            ok = false;
+            continue;
+        }
+        Entry e;
+        e.name = l.substr(0, t1);
+        e.modifier = l.substr(t1 + 1, t2 - t1 - 1);
+        e.pattern = l.substr(t2 + 1);
+        if(!isIdentifier(e.name)) {
+            std::fprintf(stderr, "%s:%lu: invalid name: %s\n", path, (unsigned long) line, e.name.c_str());
+            ok = false;
+        } else if(!names.insert(e.name).second) {
+            std::fprintf(stderr, "%s:%lu: duplicate name: %s\n", path, (unsigned long) line, e.name.c_str());
+            ok = false;
+        }
+        jp::Regex re(e.pattern, e.modifier);
+        if(!re) {
+            std::fprintf(stderr, "%s:%lu: %s: %s (offset %lu)\n", path, (unsigned long) line, e.name.c_str(),
+                         re.getErrorMessage().c_str(), (unsigned long) re.getErrorOffset());
+            ok = false;
+        } else if(re.getErrorNumber() == (int) jpcre2::ERROR::INVALID_MODIFIER) {
+            std::fprintf(stderr, "%s:%lu: %s: %s\n", path, (unsigned long) line, e.name.c_str(), re.getErrorMessage().c_str());
+            ok = false;
+        } else if(re.getErrorNumber() != 0) { //JIT compilation failed, the code is still usable (and JIT code is not embedded)
+            std::fprintf(stderr, "%s:%lu: %s: warning: %s\n", path, (unsigned long) line, e.name.c_str(), re.getErrorMessage().c_str());
+        }
+        entries.push_back(e);
+    }
+    return ok;
+}
+
+static bool writeFile(char const* path, std::string const& text){
+    std::FILE* f = std::fopen(path, "wb");
+    if(!f || std::fwrite(text.data(), 1, text.size(), f) != text.size() || std::fclose(f) != 0) {
+        std::fprintf(stderr, "%s: can not write file\n", path);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv){
+    std::string ns = "patterns";
+    int i = 1;
+    if(argc > 2 && std::string(argv[1]) == "-n") {
+        ns = argv[2];
+        i = 3;
+    }
+    if(argc - i != 3 || !isIdentifier(ns)) {
+        std::fprintf(stderr, "usage: %s [-n namespace] manifest output.hpp output.cpp\n", argv[0]);
+        return 2;
+    }
+    char const* manifest = argv[i];
+    char const* output_hpp = argv[i + 1];
+    char const* output_cpp = argv[i + 2];
+
+    std::vector<Entry> entries;
+    if(!readManifest(manifest, entries)) return 1;
+    std::vector<jp::Regex> regexes;
+    for(size_t k = 0; k < entries.size(); ++k) regexes.push_back(jp::Regex(entries[k].pattern, entries[k].modifier));
+    std::vector<unsigned char> bytes;
+    int ret = jp::Regex::serialize(regexes, bytes);
+    if(ret != 0) {
+        std::fprintf(stderr, "%s: %s\n", manifest, jp::getErrorMessage(ret, 0).c_str());
+        return 1;
+    }
+
+    std::string guard = "JPCRE2_EMBED_" + ns + "_HPP";
+    for(size_t k = 0; k < guard.size(); ++k) guard[k] = (char) std::toupper((unsigned char) guard[k]);
+    std::string header = output_hpp;
+    size_t slash = header.find_last_of("/\\");
+    if(slash != std::string::npos) header.erase(0, slash + 1);
+    std::string comment = "// Generated by jpcre2_embed from " + std::string(manifest) + ", do not edit.\n";
+
+    //the header only declares, the data and functions are defined once in the source file
+    std::string hpp = comment;
+    hpp += "#ifndef " + guard + "\n#define " + guard + "\n\n#include \"jpcre2.hpp\"\n\n";
+    hpp += "namespace " + ns + " {\n\ntypedef jpcre2::select<char> jp;\n\n";
+    hpp += "namespace detail {\n\n"
+           "extern char const* const patterns[];\n"
+           "extern char const* const modifiers[];\n\n"
+           "} //namespace detail\n\n";
+    hpp += "///All patterns in manifest order.\n"
+           "std::vector<jp::Regex> const& all();\n";
+    for(size_t k = 0; k < entries.size(); ++k) {
+        //quoted as a literal: a trailing backslash (or ??/) would continue the comment on the next line
+        hpp += "\n///" + entries[k].name + ": " + literal(entries[k].pattern) + "\n";
+        hpp += "jp::Regex " + entries[k].name + "();\n";
+    }
+    hpp += "\n} //namespace " + ns + "\n\n#endif\n";
+
+    std::string cpp = comment;
+    cpp += "#include \"" + header + "\"\n\n";
+    cpp += "namespace " + ns + " {\n\nnamespace detail {\n\n";
+    cpp += "char const* const patterns[] = {\n";
+    for(size_t k = 0; k < entries.size(); ++k) cpp += "    " + literal(entries[k].pattern) + ",\n";
+    cpp += "    0\n};\n\nchar const* const modifiers[] = {\n";
+    for(size_t k = 0; k < entries.size(); ++k) cpp += "    " + literal(entries[k].modifier) + ",\n";
+    cpp += "    0\n};\n\n";
+    cpp += "static const unsigned char data[" + jpcre2::_tostdstring(bytes.size()) + "] = {";
+    for(size_t k = 0; k < bytes.size(); ++k) {
+        if(k % 16 == 0) cpp += "\n    ";
+        char buf[16];
+        std::sprintf(buf, "0x%02x,", bytes[k]);
+        cpp += buf;
+    }
+    cpp += "\n};\n\n";
+    cpp += "static std::vector<jp::Regex> load(){\n"
+           "    std::vector<jp::Regex> regexes;\n"
+           "    std::vector<unsigned char> bytes(data, data + sizeof(data));\n"
+           "    if(jp::Regex::deserialize(bytes, regexes) != 0 || regexes.size() != " + jpcre2::_tostdstring(entries.size()) + ") {\n"
+           "        regexes.clear();\n"
+           "        for(size_t i = 0; patterns[i]; ++i) regexes.push_back(jp::Regex(patterns[i], modifiers[i]));\n"
+           "    }\n"
+           "    return regexes;\n"
+           "}\n\n} //namespace detail\n\n";
+    cpp += "std::vector<jp::Regex> const& all(){\n"
+           "    static std::vector<jp::Regex> const regexes = detail::load();\n"
+           "    return regexes;\n"
+           "}\n";
+    for(size_t k = 0; k < entries.size(); ++k)
+        cpp += "\njp::Regex " + entries[k].name + "(){ return all()[" + jpcre2::_tostdstring(k) + "]; }\n";
+    cpp += "\n} //namespace " + ns + "\n";
+
+    if(!writeFile(output_hpp, hpp) || !writeFile(output_cpp, cpp)) return 1;
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**@file test_allocator.cpp
+ *  Checks the allocator template parameter of jpcre2::select and jpcre2::pmr::select.
+ * @include test_allocator.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+#if __cplusplus >= 201103L
+
+static size_t counted = 0; //bytes allocated by Counted
+
+template<typename T>
+struct Counted {
+    typedef T value_type;
+    Counted(){}
+    template<typename U> Counted(Counted<U> const&){}
+    T* allocate(size_t n){
+        counted += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n){ std::allocator<T>().deallocate(p, n); }
+};
+template<typename T, typename U> bool operator==(Counted<T> const&, Counted<U> const&){ return true; }
+template<typename T, typename U> bool operator!=(Counted<T> const&, Counted<U> const&){ return false; }
+
+typedef jpcre2::select<char, std::map, Counted<char>> jc;
+
+static jc::String repl(jc::NumSub const& m, void*, void*){
+    return "<" + m[2] + ">";
+}
+
+#ifdef JPCRE2_USE_PMR
+//Counts the bytes taken from it.
+struct Resource : std::pmr::memory_resource {
+    size_t bytes = 0;
+    void* do_allocate(size_t n, size_t a) override {
+        bytes += n;
+        return std::pmr::new_delete_resource()->allocate(n, a);
+    }
+    void do_deallocate(void* p, size_t n, size_t a) override {
+        std::pmr::new_delete_resource()->deallocate(p, n, a);
+    }
+    bool do_is_equal(std::pmr::memory_resource const& o) const noexcept override { return this == &o; }
+};
+#endif
+
+int main(){
+    std::string const value(40, 'v');
+    jc::String subject = "first=" + jc::String(value.c_str()) + " second=" + jc::String(value.c_str());
+    size_t before = counted;
+    jc::Regex re("(?<key>\\w+)=(?<value>\\w+) (?# long enough to be allocated)");
+    assert(re && counted > before);
+
+    jc::VecNum vn;
+    jc::VecNas vs;
+    jc::VecNtN vt;
+    before = counted;
+    assert(jc::RegexMatch(&re).setSubject(&subject).setNumberedSubstringVector(&vn).setNamedSubstringVector(&vs)
+           .setNameToNumberMapVector(&vt).setFindAll().match() == 1);
+    assert(counted > before);
+    assert(vn[0][1] == "first" && vn[0][2] == value.c_str() && vs[0]["value"] == value.c_str() && vt[0]["key"] == 1);
+
+    jc::RegexReplace rr(&re);
+    jc::String out = rr.setSubject(&subject).setReplaceWith("[$2]").replace();
+    assert(out == "[" + jc::String(value.c_str()) + "]second=" + jc::String(value.c_str()));
+    assert(rr.setReplaceWith("$3").replace() == subject && rr.getErrorMessage().size());
+    assert(jc::MatchEvaluator(repl).setRegexObject(&re).setSubject(&subject).nreplace()
+           == "<" + jc::String(value.c_str()) + ">second=" + jc::String(value.c_str()));
+    jc::VecStr results;
+    assert(rr.setReplaceWith("-").replaceBatch(jc::VecStr(2, subject), results) == 2 && results[1] == out.substr(0, 0) + "-second=" + value.c_str());
+
+    #ifdef JPCRE2_USE_PMR
+    typedef jpcre2::pmr::select<char> jp;
+    Resource res;
+    jp::String s("first=" + std::string(value) + " second=" + value, &res);
+    jp::Regex pre(re.getPattern().c_str());
+    jp::VecNum pvn(&res);
+    jp::VecNas pvs(&res);
+    jp::RegexMatch rm(&pre);
+    rm.setSubject(&s).setNumberedSubstringVector(&pvn).setNamedSubstringVector(&pvs).setFindAll();
+    size_t bytes = res.bytes;
+    assert(rm.match() == 1 && res.bytes > bytes);
+    //the results are in the resource of the vectors
+    assert(pvn[0][2] == value.c_str() && pvn[0][2].get_allocator().resource() == &res);
+    assert(pvs[0]["value"].get_allocator().resource() == &res);
+    rm.setReuseResults();
+    assert(rm.match() == 1 && pvn[0][2].get_allocator().resource() == &res);
+    //replace results take the allocator of the subject
+    jp::RegexReplace prr(&pre);
+    jp::String pout = prr.setSubject(&s).setReplaceWith("[$2]").replace();
+    assert(pout.get_allocator().resource() == &res && pout.compare(out.c_str()) == 0);
+    assert(prr.setReplaceWith("$3").replace().get_allocator().resource() == &res);
+    #endif
+    return 0;
+}
+#else
+int main(){ return 0; }
+#endif
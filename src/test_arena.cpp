@@ -0,0 +1,84 @@
+/**@file test_arena.cpp
+ *  Checks jpcre2::Arena and RegexMatch::setArenaNumberedSubstringVector().
+ * @include test_arena.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    //the arena on its own
+    jpcre2::Arena arena(256);
+    assert(arena.getMemory() == 0);
+    void* p = arena.allocate(10, 1);
+    void* q = arena.allocate(8, 8);
+    assert(((size_t) q) % 8 == 0 && (char*) q >= (char*) p + 10);
+    assert(arena.getMemory() == 256);
+    arena.allocate(1000, 8); //a block of its own
+    assert(arena.getMemory() > 1256);
+    size_t total = arena.getMemory();
+    arena.reset();
+    assert(arena.getMemory() == 0);
+    arena.allocate(1000, 8);
+    arena.allocate(200, 8);
+    assert(arena.getMemory() == total); //one block now
+    arena.reset();
+    assert(arena.allocate(1, 1) != 0 && arena.getMemory() == total);
+    arena.release();
+    assert(arena.getMemory() == 0);
+
+    std::string subject;
+    for(int i = 0; i < 100; ++i) subject += "key" + jpcre2::_tostdstring(i) + "=a long enough value to not be inline ";
+    jp::Regex re("(?<key>\\w+)=(?<value>[^=]+) (?=\\w+=|$)|(x)");
+    jp::VecNum vn;
+    jp::VecNas vs;
+    jp::ArenaVecNum avn;
+    jp::ArenaVecNas avs;
+    jp::RegexMatch rm(&re);
+    rm.setSubject(&subject).setFindAll().setNumberedSubstringVector(&vn).setNamedSubstringVector(&vs)
+      .setArenaNumberedSubstringVector(&avn).setArenaNamedSubstringVector(&avs);
+    assert(rm.getArenaNumberedSubstringVector() == &avn && rm.getArenaNamedSubstringVector() == &avs);
+    assert(rm.match() == 100);
+    assert(avn.size() == 100 && avs.size() == 100);
+    for(size_t i = 0; i < vn.size(); ++i){
+        assert(avn[i].size() == vn[i].size());
+        for(size_t j = 0; j < vn[i].size(); ++j)
+            assert(std::string(avn[i][j].begin(), avn[i][j].end()) == vn[i][j]);
+        assert(avs[i].size() == vs[i].size());
+        jp::ArenaMapNas::const_iterator it = avs[i].begin();
+        for(jp::MapNas::const_iterator e = vs[i].begin(); e != vs[i].end(); ++e, ++it){
+            assert(std::string(it->first.begin(), it->first.end()) == e->first);
+            assert(std::string(it->second.begin(), it->second.end()) == e->second);
+        }
+    }
+    //the substrings are in a few blocks of the arena
+    size_t memory = rm.getArena().getMemory();
+    assert(memory > 0 && memory / JPCRE2_DEFAULT_ARENA_BLOCK_SIZE < 10);
+    assert(rm.match() == 100);
+    assert(rm.getArena().getMemory() <= memory && avn.size() == 100);
+    assert(avn[99][1] == jp::ArenaString("key99"));
+
+    //no match: the previous substrings are freed
+    rm.setSubject("nothing here");
+    assert(rm.match() == 0 && avn.empty() && avs.empty());
+
+    //the arena vectors can be used alone
+    jp::RegexMatch rm2(&re);
+    assert(rm2.setSubject(&subject).setArenaNumberedSubstringVector(&avn).match() == 1);
+    assert(avn.size() == 1 && avn[0][2] == jp::ArenaString("a long enough value to not be inline"));
+    rm2.reset(); //frees the substrings, and clears the vector
+    assert(rm2.getArena().getMemory() == 0 && avn.empty());
+
+    //a copy doesn't fill the vectors of the original, whose arena clears them
+    rm2.setRegexObject(&re).setSubject(&subject).setArenaNumberedSubstringVector(&avn);
+    jp::RegexMatch rm3(rm2);
+    assert(rm3.getArenaNumberedSubstringVector() == 0 && rm3.getArenaNamedSubstringVector() == 0);
+    assert(rm3.match() == 1 && avn.empty());
+    assert(rm2.match() == 1 && avn.size() == 1);
+    rm3 = rm2;
+    assert(rm3.getArenaNumberedSubstringVector() == 0);
+    return 0;
+}
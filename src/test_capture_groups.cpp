@@ -0,0 +1,111 @@
+/**@file test_capture_groups.cpp
+ *  Checks RegexMatch::addCaptureGroup().
+ * @include test_capture_groups.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+#ifdef JPCRE2_UNSET_CAPTURES_NULL
+#define EMPTY(x) (!(x))
+#define TEXT(x) (*(x))
+#else
+#define EMPTY(x) ((x).empty())
+#define TEXT(x) (x)
+#endif
+
+static std::string valueOnly(jp::NumSub const& m, void*, void*){
+    return "<" + TEXT(m[3]) + ">";
+}
+
+int main(){
+    std::string subject = "a:x=1, b:y=22, c:z=333";
+    jp::Regex re("(?<ns>\\w):(?<key>\\w)=(?<value>\\d+)");
+    jp::VecNum vn;
+    jp::VecNas vs;
+    jp::VecNtN vt;
+    jpcre2::VecOff eoff;
+    jp::RegexMatch rm(&re);
+    rm.setSubject(&subject).setNumberedSubstringVector(&vn).setNamedSubstringVector(&vs)
+      .setNameToNumberMapVector(&vt).setMatchEndOffsetVector(&eoff).setFindAll();
+
+    //by number: the vector goes up to the highest group, the others are empty
+    assert(rm.addCaptureGroup(0).addCaptureGroup(2).match() == 3);
+    assert(vn.size() == 3 && vn[1].size() == 3);
+    assert(TEXT(vn[1][0]) == "b:y=22" && EMPTY(vn[1][1]) && TEXT(vn[1][2]) == "y");
+    assert(vs[2].size() == 1 && vs[2]["key"] == "z" && vt[2].size() == 1 && vt[2]["key"] == 2);
+    assert(eoff.size() == 3 && eoff[2] == subject.size()); //offsets are always there
+
+    //by name, with numbers too
+    rm.clearCaptureGroups().addCaptureGroup("value").addCaptureGroup(1);
+    assert(rm.match() == 3);
+    assert(vn[0].size() == 4 && EMPTY(vn[0][0]) && TEXT(vn[0][1]) == "a" && EMPTY(vn[0][2]) && TEXT(vn[0][3]) == "1");
+    assert(vs[1].size() == 2 && vs[1]["ns"] == "b" && vs[1]["value"] == "22" && vs[1].count("key") == 0);
+
+    //unknown groups: nothing to extract
+    rm.clearCaptureGroups().addCaptureGroup(9).addCaptureGroup("nothing");
+    assert(rm.match() == 3 && vn.size() == 3 && vn[0].empty() && vs[0].empty());
+
+    //all again
+    assert(rm.clearCaptureGroups().match() == 3 && vn[2].size() == 4 && vs[2].size() == 3);
+
+    //another pattern: the names are looked up again
+    jp::Regex re2("(?<value>\\d+)(?<key>)");
+    rm.addCaptureGroup("value");
+    assert(rm.match() == 3 && vn.size() == 3 && vs[0].size() == 1);
+    assert(rm.setRegexObject(&re2).match() == 3);
+    assert(vn[2].size() == 2 && TEXT(vn[2][1]) == "333" && vs[2].size() == 1 && vs[2]["value"] == "333");
+
+    //duplicate names: all groups of the name
+    jp::Regex dup("(?<n>a)(b)|(?<n>c)(d)", "J");
+    jp::VecNum dn;
+    assert(jp::RegexMatch(&dup).setSubject("ab cd").setNumberedSubstringVector(&dn).setFindAll()
+           .addCaptureGroup("n").match() == 2);
+    assert(dn[0].size() == 4 && TEXT(dn[0][1]) == "a" && EMPTY(dn[0][2]) && TEXT(dn[1][3]) == "c");
+
+    //copies, reused results and arena vectors
+    jp::ArenaVecNum avn;
+    jp::ArenaVecNas avs;
+    jp::RegexMatch copy(rm);
+    copy.setRegexObject(&re).setReuseResults().setArenaNumberedSubstringVector(&avn).setArenaNamedSubstringVector(&avs);
+    assert(copy.match() == 3 && copy.match() == 3);
+    assert(vn[1].size() == 4 && TEXT(vn[1][3]) == "22" && EMPTY(vn[1][1]) && vs[1].size() == 1);
+    assert(avn[1].size() == 4 && TEXT(avn[1][3]) == jp::ArenaString("22") && EMPTY(avn[1][1]) && avs[1].size() == 1);
+    copy.clearCaptureGroups();
+    assert(copy.match() == 3 && vs[1].size() == 3 && vs[1]["key"] == "y");
+    rm.reset();
+    assert(rm.setRegexObject(&re).setSubject(&subject).setNumberedSubstringVector(&vn).match() == 1 && vn[0].size() == 4);
+
+    jp::MatchEvaluator me(valueOnly);
+    assert(me.setRegexObject(&re).setSubject(&subject).setFindAll().addCaptureGroup("value").nreplace() == "<1>, <22>, <333>");
+
+    //compiled again with the name on another group (the new code may get the address of the old one)
+    jp::Regex same;
+    jp::VecNum sn;
+    jp::RegexMatch srm(&same);
+    srm.setSubject("xy").setNumberedSubstringVector(&sn).addCaptureGroup("k");
+    for(int i = 0; i < 4; ++i){
+        if(i % 2 == 0) {
+            same.compile("(?<k>x)(y)");
+            assert(srm.match() == 1 && sn[0].size() == 2 && TEXT(sn[0][1]) == "x");
+        } else {
+            same.compile("(x)(?<k>y)");
+            assert(srm.match() == 1 && sn[0].size() == 3 && EMPTY(sn[0][1]) && TEXT(sn[0][2]) == "y");
+        }
+    }
+
+    #ifdef JPCRE2_USE_THREADS
+    std::string big;
+    for(int i = 0; i < 2000; ++i) big += "n:k=" + jpcre2::_tostdstring(i) + " ";
+    jpcre2::ThreadPool pool(4);
+    jp::VecNum pn;
+    jp::RegexMatch prm(&re);
+    assert(prm.setSubject(&big).setNumberedSubstringVector(&pn).setFindAll().setThreadPool(&pool).setChunkSize(1000)
+           .addCaptureGroup("value").match() == 2000);
+    assert(pn[1999].size() == 4 && TEXT(pn[1999][3]) == "1999" && EMPTY(pn[1999][0]) && EMPTY(pn[0][2]));
+    #endif
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**@file test_compile_all.cpp
+ *  Checks Regex::compileAll() and Regex::compileAsync().
+ * @include test_compile_all.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static jp::VecStr makePatterns(){
+    jp::VecStr patterns;
+    for(unsigned i = 0; i < 2000; ++i){
+        std::string n = jpcre2::_tostdstring(i);
+        if(i % 100 == 7) patterns.push_back("(" + n);  //invalid
+        else patterns.push_back("(?<id>" + n + ")-\\w+|rule" + n + "[a-f]{2,}");
+    }
+    return patterns;
+}
+
+static void check(jp::VecStr const& patterns, std::vector<jp::Regex>& regexes, jpcre2::SIZE_T failed){
+    assert(regexes.size() == patterns.size());
+    assert(failed == 20);
+    for(size_t i = 0; i < regexes.size(); ++i){
+        assert(regexes[i].getPattern() == patterns[i]);
+        if(i % 100 == 7) {
+            assert(regexes[i].getPcre2Code() == 0);
+            assert(regexes[i].getErrorNumber() != 0);
+            assert((size_t) regexes[i].getErrorOffset() == patterns[i].size());
+        } else {
+            assert(regexes[i].getPcre2Code() != 0);
+            assert(regexes[i].getErrorNumber() == 0);
+            std::string n = jpcre2::_tostdstring(i);
+            assert(regexes[i].match(n + "-x rule" + n + "ab", "g") == 2);
+        }
+    }
+}
+
+int main(){
+    jp::VecStr patterns = makePatterns();
+    std::vector<jp::Regex> regexes;
+    check(patterns, regexes, jp::Regex::compileAll(patterns, "S", regexes));
+
+    //settings of each object are used
+    std::vector<jp::Regex> objs(2);
+    objs[0].setPattern("abc").setModifier("i");
+    objs[1].setPattern("a(").setModifier("x");
+    assert(jp::Regex::compileAll(objs) == 1);
+    assert(objs[0].match("ABC") == 1);
+
+    #ifdef JPCRE2_USE_THREADS
+    jpcre2::ThreadPool pool(4);
+    std::vector<jp::Regex> pregexes;
+    check(patterns, pregexes, jp::Regex::compileAll(patterns, "S", pregexes, &pool));
+    assert(jp::Regex::compileAll(objs, &pool) == 1);
+
+    //with a shared cache
+    jp::RegexCache cache;
+    std::vector<jp::Regex> cached(1000);
+    for(size_t i = 0; i < cached.size(); ++i) cached[i].setCache(&cache).setPattern(patterns[i % 7]).setModifier("S");
+    assert(jp::Regex::compileAll(cached, &pool) == 0);
+    assert(cache.size() == 7);
+
+    //async with a future
+    jp::Regex re;
+    re.setPattern("(\\d+)").setModifier("S");
+    std::future<int> f = re.compileAsync(&pool);
+    assert(f.get() == 0);
+    assert(re.match("a 12 b 345", "g") == 2);
+    jp::Regex bad;
+    bad.setPattern("[a");
+    assert(bad.compileAsync().get() != 0);
+    assert(bad.getPcre2Code() == 0);
+
+    //async with a callback
+    std::promise<bool> done;
+    jp::Regex re2;
+    re2.setPattern("x+");
+    re2.compileAsync(&pool, [&done](jp::Regex& r){ done.set_value(r.getPcre2Code() != 0); });
+    assert(done.get_future().get());
+    assert(re2.match("xx") == 1);
+
+    //a callback that throws doesn't end the program
+    std::promise<void> thrown, pthrown;
+    jp::Regex re3, re4;
+    re3.setPattern("y+");
+    re3.compileAsync(0, [&thrown](jp::Regex&){ thrown.set_value(); throw 1; });
+    thrown.get_future().get();
+    re4.setPattern("z+");
+    re4.compileAsync(&pool, [&pthrown](jp::Regex&){ pthrown.set_value(); throw std::runtime_error("callback"); });
+    pthrown.get_future().get();
+    assert(re3.match("yy") == 1 && re4.match("zz") == 1);
+    jp::Regex re5;
+    re5.setPattern("w+");
+    assert(re5.compileAsync(&pool).get() == 0); //the pool is still working
+    #endif
+    return 0;
+}
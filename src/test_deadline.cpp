@@ -0,0 +1,128 @@
+/**@file test_deadline.cpp
+ *  Checks deadlines, timeouts and cancel tokens, see RegexMatch::setDeadline().
+ * @include test_deadline.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+#if __cplusplus >= 201103L
+#include <thread>
+
+typedef jpcre2::select<char> jp;
+
+static std::string repl(jp::NumSub const&, void*, void*){
+    return "#";
+}
+
+static int countCallout(jp::CalloutBlock*, void* data){
+    ++*static_cast<int*>(data);
+    return 0;
+}
+
+int main(){
+    std::string bad(40, 'a');
+    bad += "b";                 //catastrophic backtracking for (a+)+$
+    std::string text = "aaa\naa\n" + bad;
+    std::chrono::milliseconds ms(20);
+
+    //callouts let a single long match be stopped
+    jp::Regex re("^(a+)+$", PCRE2_MULTILINE | PCRE2_AUTO_CALLOUT);
+    re.setMatchLimit(0xFFFFFFFF);
+    jp::VecNum vec;
+    jp::RegexMatch rm(&re);
+    rm.setSubject(text).setFindAll().setNumberedSubstringVector(&vec).setTimeout(ms);
+    assert(rm.getTimeout() == ms);
+    assert(rm.match() == 2);    //the matches before it are kept
+    assert(vec.size() == 2 && vec[1][0] == "aa");
+    assert(rm.isTimedOut() && !rm.isCancelled());
+    assert(rm.getErrorNumber() == jpcre2::ERROR::TIMEOUT);
+    assert(rm.getErrorMessage() == "deadline exceeded");
+    rm.resetErrors();
+    assert(rm.setSubject("aaa\naaa").match() == 2); //started again on each match()
+    assert(!rm.isTimedOut());
+
+    //a deadline that has passed
+    rm.setTimeout(std::chrono::nanoseconds::zero()).setDeadline(std::chrono::steady_clock::now());
+    assert(rm.match() == 0 && rm.isTimedOut());
+    rm.resetErrors();
+    rm.setDeadline(std::chrono::steady_clock::time_point::max());
+    assert(rm.match() == 2 && !rm.isTimedOut());
+
+    //cancel from another thread
+    jpcre2::CancelToken token;
+    rm.setSubject(text).setCancelToken(&token);
+    assert(rm.getCancelToken() == &token);
+    std::thread t([&token, ms]{ std::this_thread::sleep_for(ms); token.cancel(); });
+    assert(rm.match() == 2);
+    t.join();
+    assert(rm.isCancelled() && rm.getErrorNumber() == jpcre2::ERROR::CANCELLED);
+    rm.resetErrors();
+    assert(rm.match() == 0 && rm.isCancelled()); //stays cancelled until reset
+    token.reset();
+    rm.resetErrors();
+    assert(rm.setSubject("aaa").match() == 1);
+    rm.setCancelToken(0);
+
+    //replace keeps the replacements done before the deadline
+    jp::RegexReplace rr(&re);
+    rr.setSubject(text).setReplaceWith("#").setModifier("g").setTimeout(ms);
+    assert(rr.replace() == "#\n#\n" + bad);
+    assert(rr.getLastReplaceCount() == 2);
+    assert(rr.isTimedOut());
+    rr.resetErrors();
+    assert(rr.setSubject("aa\naa").replace() == "#\n#" && !rr.isTimedOut());
+    rr.setSubject(text);
+    assert(rr.nreplace(jp::MatchEvaluator(repl)) == "#\n#\n" + bad); //passed on to the MatchEvaluator
+    jp::MatchEvaluator me(repl);
+    assert(me.setRegexObject(&re).setSubject(text).setFindAll().setTimeout(ms).nreplace() == "#\n#\n" + bad);
+    assert(me.isTimedOut());
+
+    //a batch leaves the subjects after the deadline as they are
+    jp::VecStr subjects(3, "aa"), results;
+    subjects[1] = bad;
+    rr.resetErrors();
+    assert(rr.replaceBatch(subjects, results) == 1);
+    assert(results[0] == "#" && results[1] == bad && results[2] == "aa");
+    assert(rr.isTimedOut());
+
+    //the callout set with setCallout() is still called with a deadline
+    int calls = 0;
+    jp::RegexMatch rmc(&re);
+    rmc.setSubject("aaa").setCallout(countCallout, &calls);
+    assert(rmc.match() == 1 && calls > 0);
+    calls = 0;
+    assert(rmc.setTimeout(std::chrono::seconds(60)).match() == 1 && calls > 0);
+    calls = 0;
+    assert(rmc.setSubject(bad).setTimeout(ms).match() == 0 && rmc.isTimedOut() && calls > 0);
+    calls = 0;
+    jp::RegexReplace rrc(&re);
+    assert(rrc.setSubject("aaa").setReplaceWith("#").setTimeout(ms).setCallout(countCallout, &calls).replace() == "#");
+    assert(calls > 0);
+    calls = 0;
+    assert(rrc.nreplace(jp::MatchEvaluator(repl)) == "#" && calls > 0); //passed on to the MatchEvaluator
+
+    //reset() and clear() drop the deadline, the timeout and the cancel token
+    rmc.setDeadline(std::chrono::steady_clock::now()).setCancelToken(&token).reset();
+    assert(rmc.getDeadline() == std::chrono::steady_clock::time_point::max());
+    assert(rmc.getTimeout() == std::chrono::nanoseconds::zero() && rmc.getCancelToken() == 0);
+    assert(rmc.setRegexObject(&re).setSubject("aaa").match() == 1 && !rmc.isTimedOut());
+    rrc.setDeadline(std::chrono::steady_clock::now()).clear();
+    assert(rrc.setRegexObject(&re).setSubject("aaa").setReplaceWith("#").replace() == "#" && !rrc.isTimedOut());
+
+    #ifdef JPCRE2_USE_THREADS
+    std::string big;
+    for(int i = 0; i < 200; ++i) big += "aaaa\n";
+    big += bad;
+    jpcre2::ThreadPool pool(4);
+    jp::RegexMatch prm(&re);
+    prm.setSubject(big).setFindAll().setThreadPool(&pool).setChunkSize(256).setTimeout(ms);
+    assert(prm.match() <= 200);
+    assert(prm.isTimedOut());
+    #endif
+    return 0;
+}
+#else
+int main(){ return 0; }
+#endif
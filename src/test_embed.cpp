@@ -0,0 +1,44 @@
+/**@file test_embed.cpp
+ *  Checks the header generated by jpcre2_embed from test_embed.manifest.
+ * @include test_embed.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+#include "test_embed_bundle.hpp"
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    std::vector<jp::Regex> const& all = test_bundle::all();
+    assert(all.size() == 4);
+    for(size_t i = 0; i < all.size(); ++i){
+        assert(all[i].getPcre2Code() != 0);
+        jp::Regex re(test_bundle::detail::patterns[i], test_bundle::detail::modifiers[i]);
+        assert(all[i].getPattern() == re.getPattern());
+        assert(all[i].getPcre2Option() == re.getPcre2Option());
+        assert(all[i].getJpcre2Option() == re.getJpcre2Option());
+    }
+    assert(test_bundle::detail::patterns[4] == 0);
+
+    //accessors give copies that share the loaded code
+    jp::Regex date = test_bundle::date();
+    assert(date.getPcre2Code() == all[0].getPcre2Code());
+    assert(date.getPattern() == "(?<y>\\d{4})-(?<m>\\d\\d)-(?<d>\\d\\d)");
+    jp::VecNas vn;
+    assert(date.initMatch().setSubject("on 2024-01-02").setNamedSubstringVector(&vn).match() == 1);
+    assert(vn[0]["y"] == "2024" && vn[0]["d"] == "02");
+
+    assert(test_bundle::word().match("ABC def", "g") == 2);
+
+    //escaped pattern: quotes, backslashes, '??' and a tab
+    jp::Regex quoted = test_bundle::quoted();
+    assert(quoted.getPattern() == "\"(?:[^\"\\\\]|\\\\.)*\"?" "?\ttab");
+    assert(quoted.match("x \"a\\\"b\"\ttab") == 1);
+
+    //a pattern ending with a backslash does not swallow the next declaration in the header's comment
+    assert(test_bundle::backslash().getPattern() == "\\\\");
+    assert(test_bundle::backslash().match("a\\b") == 1);
+    return 0;
+}
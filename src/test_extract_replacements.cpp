@@ -0,0 +1,59 @@
+/**@file test_extract_replacements.cpp
+ *  Checks RegexReplace::extractReplacements().
+ * @include test_extract_replacements.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+struct Joiner {
+    std::string joined;
+    void operator()(std::string const& s){
+        joined += s + ";";
+    }
+};
+
+int main(){
+    #ifdef PCRE2_SUBSTITUTE_REPLACEMENT_ONLY
+    jp::Regex re("(?<key>\\w+)=(\\w*)");
+    std::string subject = "a=1 bb=22 c= ddd=444";
+    jp::VecStr vec;
+    size_t count = 0;
+    jp::RegexReplace rr(&re);
+    rr.setSubject(subject).setReplaceWith("$2-${key}").setModifier("g").setReplaceCounter(&count);
+    assert(rr.extractReplacements(&vec) == 4);
+    assert(count == 4);
+    assert(vec.size() == 4);
+    assert(vec[0] == "1-a" && vec[1] == "22-bb" && vec[2] == "-c" && vec[3] == "444-ddd");
+
+    //vector is cleared, only the first match without 'g'
+    assert(rr.setModifier("").extractReplacements(&vec) == 1);
+    assert(vec.size() == 1 && vec[0] == "1-a");
+
+    //start offset and a small buffer
+    assert(rr.setModifier("g").setStartOffset(4).setBufferSize(1).extractReplacements(&vec) == 3);
+    assert(vec[0] == "22-bb");
+
+    //sink
+    Joiner joiner;
+    assert(rr.setStartOffset(0).extractReplacements(joiner) == 4);
+    assert(joiner.joined == "1-a;22-bb;-c;444-ddd;");
+
+    //empty matches
+    jp::Regex re2("x*");
+    assert(jp::RegexReplace(&re2).setSubject("ab").setReplaceWith("[$0]").setModifier("g").extractReplacements(&vec) == 3);
+    assert(vec.size() == 3 && vec[0] == "[]");
+
+    //error keeps the replacements before it
+    assert(rr.setReplaceWith("$2").setModifier("gE").extractReplacements(&vec) == 4);
+    jp::Regex re3("(\\d)(9)?");
+    jp::RegexReplace rr3(&re3);
+    rr3.setSubject("19 2").setReplaceWith("$2").setModifier("g").extractReplacements(&vec);
+    assert(rr3.getErrorNumber() == PCRE2_ERROR_UNSET);
+    assert(vec.size() == 1 && vec[0] == "9");
+    #endif
+    return 0;
+}
@@ -0,0 +1,71 @@
+/**@file test_flat_map.cpp
+ *  Checks jpcre2::FlatMap and JPCRE2_USE_FLAT_MAP.
+ * @include test_flat_map.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#define JPCRE2_USE_FLAT_MAP
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static std::string swapKeyValue(void*, jp::MapNas const& m, void*){
+    return m.find("value")->second + "=" + m.at("key");
+}
+
+int main(){
+    //the map on its own
+    jpcre2::FlatMap<std::string, int> m;
+    assert(m.empty() && m.find("a") == m.end() && m.count("a") == 0);
+    m["b"] = 2;
+    m["d"] = 4;
+    m["a"] = 1;
+    m["c"] = 3;
+    assert(m.size() == 4 && m["c"] == 3 && m.size() == 4);
+    std::string keys;
+    for(jpcre2::FlatMap<std::string, int>::const_iterator it = m.begin(); it != m.end(); ++it) keys += it->first;
+    assert(keys == "abcd");
+    assert(m.find("b")->second == 2 && m.count("d") == 1 && m.lower_bound("bb")->first == "c");
+    assert(!m.insert(std::make_pair(std::string("a"), 9)).second && m.at("a") == 1);
+    assert(m.insert(std::make_pair(std::string("e"), 5)).second && m.rbegin()->second == 5);
+    assert(m.erase("b") == 1 && m.erase("b") == 0 && m.size() == 4);
+    bool thrown = false;
+    try { m.at("b"); } catch(std::out_of_range const&) { thrown = true; }
+    assert(thrown);
+    jpcre2::FlatMap<std::string, int> copy(m.begin(), m.end());
+    assert(copy == m);
+    copy.clear();
+    assert(copy.empty() && copy != m);
+    copy.swap(m);
+    assert(m.empty() && copy.size() == 4);
+
+    //named substrings
+    std::string subject = "x=1, y=22, z=333";
+    jp::Regex re("(?<key>\\w)=(?<value>\\d+)");
+    jp::VecNas vec_nas;
+    jp::VecNtN vec_ntn;
+    jp::RegexMatch rm(&re);
+    assert(rm.setSubject(&subject).setNamedSubstringVector(&vec_nas).setNameToNumberMapVector(&vec_ntn)
+             .setFindAll().match() == 3);
+    assert(vec_nas[1]["key"] == "y" && vec_nas[1]["value"] == "22" && vec_nas[2].size() == 2);
+    assert(vec_ntn[0]["key"] == 1 && vec_ntn[0]["value"] == 2);
+    assert(vec_nas[0].capacity() == 2); //appended in order
+    assert(jp::MatchEvaluator(swapKeyValue).setRegexObject(&re).setSubject(&subject).setFindAll().nreplace()
+           == "1=x, 22=y, 333=z");
+
+    #if __cplusplus >= 201103L
+    //the same results as std::map
+    typedef jpcre2::select<char, std::map> js;
+    js::VecNas vs;
+    js::Regex rs("(?<key>\\w)=(?<value>\\d+)");
+    assert(js::RegexMatch(&rs).setSubject(&subject).setNamedSubstringVector(&vs).setFindAll().match() == 3);
+    for(size_t i = 0; i < vs.size(); ++i) {
+        assert(vs[i].size() == vec_nas[i].size());
+        for(js::MapNas::const_iterator it = vs[i].begin(); it != vs[i].end(); ++it)
+            assert(vec_nas[i][it->first] == it->second);
+    }
+    #endif
+    return 0;
+}
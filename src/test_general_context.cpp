@@ -0,0 +1,76 @@
+/**@file test_general_context.cpp
+ *  Checks select::setGeneralContext().
+ * @include test_general_context.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include <cstdlib>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+struct Counter {
+    size_t allocs;
+    size_t frees;
+    size_t bytes;
+};
+
+static void* countedMalloc(PCRE2_SIZE size, void* data){
+    Counter* c = (Counter*) data;
+    ++c->allocs;
+    c->bytes += size;
+    return malloc(size);
+}
+
+static void countedFree(void* p, void* data){
+    if(p) ++((Counter*) data)->frees;
+    free(p);
+}
+
+int main(){
+    Counter c = {0, 0, 0};
+    jp::GeneralContext* gc = jp::createGeneralContext(countedMalloc, countedFree, &c);
+    assert(gc && jp::getGeneralContext() == 0);
+    jp::setGeneralContext(gc);
+    assert(jp::getGeneralContext() == gc);
+    {
+        jp::Regex re("(\\w+)=(\\d+)", "S");
+        assert(re.getPcre2Code() && c.allocs > 0);
+        size_t allocs = c.allocs;
+
+        std::string subject = "a=1 b=2 c=x d=4";
+        jp::VecNum vec;
+        jp::RegexMatch rm(&re);
+        assert(rm.setSubject(&subject).setNumberedSubstringVector(&vec).setFindAll().match() == 3);
+        assert(vec[2][1] == "d" && c.allocs > allocs);
+
+        allocs = c.allocs;
+        assert(jp::RegexReplace(&re).setSubject(&subject).setReplaceWith("$2").setModifier("g").replace() == "1 2 c=x 4");
+        assert(c.allocs > allocs);
+
+        allocs = c.allocs;
+        jp::Regex tables;
+        tables.resetCharacterTables().compile("[[:alpha:]]+");
+        assert(tables.getPcre2Code() && c.allocs > allocs);
+
+        std::vector<unsigned char> bytes;
+        std::vector<jp::Regex> loaded;
+        allocs = c.allocs;
+        assert(jp::Regex::serialize(std::vector<jp::Regex>(1, re), bytes) == 0);
+        assert(jp::Regex::deserialize(bytes, loaded) == 0 && loaded.size() == 1);
+        assert(c.allocs > allocs);
+        assert(jp::RegexMatch(&loaded[0]).setSubject(&subject).setFindAll().match() == 3);
+    }
+    assert(c.frees + 1 == c.allocs); //everything but the context itself is freed through it
+
+    //unset: the context can be freed, new objects don't use it
+    jp::setGeneralContext(0);
+    jp::freeGeneralContext(gc);
+    assert(c.frees == c.allocs);
+    size_t allocs = c.allocs;
+    jp::Regex re("\\d");
+    assert(jp::RegexMatch(&re).setSubject("1 2").setFindAll().match() == 2);
+    assert(c.allocs == allocs);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**@file test_jit_match.cpp
+ *  Checks that matches done with pcre2_jit_match() (JIT compiled patterns)
+ *  give the same results as pcre2_match().
+ * @include test_jit_match.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static void check(std::string const& pat, std::string const& cmod, std::string const& subject,
+                  std::string const& mmod, uint32_t opts = 0, jpcre2::SIZE_T offset = 0){
+    jp::Regex jit(pat, cmod + "S"), plain(pat, cmod);
+    assert(jit.getPcre2Code() != 0 && plain.getPcre2Code() != 0);
+    jp::VecNum vn1, vn2;
+    jpcre2::VecOff so1, so2, eo1, eo2;
+    jp::RegexMatch rm1(&plain), rm2(&jit);
+    size_t c1 = rm1.setSubject(subject).setModifier(mmod).addPcre2Option(opts).setStartOffset(offset)
+                   .setNumberedSubstringVector(&vn1).setMatchStartOffsetVector(&so1).setMatchEndOffsetVector(&eo1).match();
+    size_t c2 = rm2.setSubject(subject).setModifier(mmod).addPcre2Option(opts).setStartOffset(offset)
+                   .setNumberedSubstringVector(&vn2).setMatchStartOffsetVector(&so2).setMatchEndOffsetVector(&eo2).match();
+    assert(c1 == c2);
+    assert(vn1 == vn2 && so1 == so2 && eo1 == eo2);
+    assert(rm1.getErrorNumber() == rm2.getErrorNumber());
+}
+
+static int error(std::string const& pat, std::string const& cmod, std::string const& subject, jpcre2::SIZE_T offset = 0){
+    jp::RegexMatch rm;
+    jp::Regex re(pat, cmod);
+    rm.setRegexObject(&re).setSubject(subject).setStartOffset(offset).match();
+    return rm.getErrorNumber();
+}
+
+int main(){
+    std::string text = "one two\nthree  four\n\nfive";
+    check("\\w+", "", text, "g");
+    check("x*", "", text, "g");                         //empty matches, anchored retries
+    check("^\\w+", "m", text, "g", PCRE2_NOTBOL);
+    check("\\w+$", "m", text, "g", PCRE2_NOTEOL);
+    check("\\b", "", text, "g", PCRE2_NOTEMPTY_ATSTART);
+    check("(\\w)(\\w)?", "", text, "g", PCRE2_NOTEMPTY);
+    check("(?<w>\\w+)\\s+\\g{w}?", "", text, "g", 0, 5);
+    check("\\w+", "", text, "", PCRE2_ANCHORED);        //not allowed by pcre2_jit_match()
+    check("\\w+", "", text, "g", PCRE2_PARTIAL_HARD);   //not allowed either
+
+    //UTF: the first match checks the subject
+    std::string utf = "\xc3\xa9t\xc3\xa9 \xe2\x82\xac" "12 caf\xc3\xa9";
+    check("\\w+", "u", utf, "g");
+    check("", "u", utf, "g");
+    check(".", "u", utf, "g", PCRE2_NO_UTF_CHECK);
+    assert(error("\\w", "uS", "ab\xc3") == PCRE2_ERROR_UTF8_ERR1);
+    assert(error("\\w", "u", "ab\xc3") == PCRE2_ERROR_UTF8_ERR1);
+
+    //offset past the end
+    assert(error("\\w", "S", "ab", 3) == PCRE2_ERROR_BADOFFSET);
+    assert(error("\\w", "", "ab", 3) == PCRE2_ERROR_BADOFFSET);
+
+    //deferred JIT
+    jp::Regex re;
+    re.setJitThreshold(2).compile("(\\d)+", "S");
+    for(int i = 0; i < 5; ++i){
+        jp::VecNum vn;
+        assert(re.initMatch().setSubject("a 12 b 345").setNumberedSubstringVector(&vn).setFindAll().match() == 2);
+        assert(vn[1][0] == "345" && vn[1][1] == "5");
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**@file test_jit_stack.cpp
+ *  Checks the JIT stack growth, see RegexMatch::setJitStackLimit().
+ * @include test_jit_stack.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static std::string star(jp::NumSub const& m, void*, void*){
+    return "<" + m[1] + ">";
+}
+
+int main(){
+    uint32_t jit = 0;
+    pcre2_config_8(PCRE2_CONFIG_JIT, &jit);
+    if(!jit) return 0;
+
+    //needs more than the default 32K JIT stack
+    std::string subject;
+    for(int i = 0; i < 1000; ++i) subject += "ab";
+    subject += "c";
+    jp::Regex re("(a|b)*c", "S");
+    assert(re.isJitCompiled());
+
+    jp::RegexMatch rm(&re);
+    assert(rm.getJitStackLimit() == JPCRE2_DEFAULT_JIT_STACK_LIMIT);
+    jp::VecNum vn;
+    rm.setSubject(subject).setNumberedSubstringVector(&vn);
+    assert(rm.setJitStackLimit(0).match() == 0);
+    assert(rm.getErrorNumber() == PCRE2_ERROR_JIT_STACKLIMIT);
+    rm.resetErrors();
+    assert(rm.setJitStackLimit(32768).match() == 0);
+    assert(rm.getErrorNumber() == PCRE2_ERROR_JIT_STACKLIMIT);
+    rm.resetErrors();
+    assert(rm.setJitStackLimit(JPCRE2_DEFAULT_JIT_STACK_LIMIT).match() == 1);
+    assert(rm.getErrorNumber() == 0);
+    assert(vn[0][0] == subject && vn[0][1] == "b");
+    assert(rm.match() == 1); //the stack is kept
+    assert(rm.setSubject(subject + " " + subject).setFindAll().match() == 2);
+
+    //with a match context of our own
+    pcre2_match_context_8* mc = pcre2_match_context_create_8(0);
+    rm.setMatchContext(mc).setFindAll(false);
+    assert(rm.match() == 1);
+    assert(rm.getMatchContext() == mc);
+    assert(rm.getErrorNumber() == 0);
+    rm.setMatchContext(0);
+    pcre2_match_context_free_8(mc);
+
+    //replace
+    assert(re.initReplace().setSubject(subject).setReplaceWith("#").setJitStackLimit(0).replace() == subject);
+    jp::RegexReplace rr(&re);
+    rr.setSubject(subject + subject).setReplaceWith("[$1]").setModifier("g");
+    assert(rr.replace() == "[b][b]");
+    assert(rr.getErrorNumber() == 0);
+    assert(rr.nreplace(jp::MatchEvaluator(star)) == "<b><b>");
+    assert(rr.getErrorNumber() == 0);
+    jp::VecStr subjects(3, subject);
+    jp::VecStr results;
+    assert(rr.replaceBatch(subjects, results) == 3);
+    assert(results[2] == "[b]");
+    return 0;
+}
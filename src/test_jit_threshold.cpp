@@ -0,0 +1,76 @@
+/**@file test_jit_threshold.cpp
+ *  Checks the deferred (adaptive) JIT compilation, see Regex::setJitThreshold().
+ * @include test_jit_threshold.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+#ifdef JPCRE2_USE_THREADS
+#include <chrono>
+#endif
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    uint32_t jit = 0;
+    pcre2_config_8(PCRE2_CONFIG_JIT, &jit);
+    std::string subject = "a 12 b 345 c 6789";
+
+    //default: JIT compiled by compile()
+    jp::Regex eager("\\d+", "S");
+    assert(eager.getJitThreshold() == 0);
+    assert(eager.isJitCompiled() == (jit != 0));
+
+    //no JIT without 'S'
+    jp::Regex plain;
+    plain.setJitThreshold(1).compile("\\d+");
+    for(int i = 0; i < 5; ++i) assert(plain.match(subject, "g") == 3);
+    assert(!plain.isJitCompiled());
+
+    jp::Regex re;
+    re.setJitThreshold(3).compile("\\d+", "S");
+    assert(re.getJitThreshold() == 3);
+    assert(!re.isJitCompiled());
+    assert(re.match(subject, "g") == 3);
+    jp::Regex copy = re; //copies count together
+    assert(copy.getJitThreshold() == 3);
+    assert(copy.replace(subject, "#", "g") == "a # b # c #");
+    assert(!re.isJitCompiled() && !copy.isJitCompiled());
+    assert(re.match(subject, "g") == 3); //third use
+    assert(re.isJitCompiled() == (jit != 0));
+    assert(copy.isJitCompiled() == (jit != 0));
+    assert(copy.match(subject, "g") == 3);
+    assert(re.replace(subject, "[$0]", "g") == "a [12] b [345] c [6789]");
+
+    //recompile starts over
+    re.compile("\\w+", "S");
+    assert(!re.isJitCompiled());
+    assert(copy.isJitCompiled() == (jit != 0));
+
+    //deserialized code is JIT compiled on its first use
+    std::vector<jp::Regex> regexes(1, eager);
+    std::vector<unsigned char> bytes;
+    assert(jp::Regex::serialize(regexes, bytes) == 0);
+    assert(jp::Regex::deserialize(bytes, regexes) == 0);
+    assert(!regexes[0].isJitCompiled());
+    assert(regexes[0].match(subject) == 1);
+    assert(regexes[0].isJitCompiled() == (jit != 0));
+
+    #ifdef JPCRE2_USE_THREADS
+    //JIT compiled on a pool while other threads match
+    jpcre2::ThreadPool pool(4), jit_pool(1);
+    jp::Regex hot;
+    hot.setJitThreshold(50).setJitThreadPool(&jit_pool).compile("(\\w)(\\d+)", "S");
+    pool.parallelFor(400, [&hot](jpcre2::SIZE_T){
+        jp::VecNum vn;
+        assert(hot.initMatch().setSubject("no digits").setNumberedSubstringVector(&vn).setFindAll().match() == 0);
+        assert(hot.initMatch().setSubject("x1 y22").setNumberedSubstringVector(&vn).setFindAll().match() == 2);
+        assert(vn[1][2] == "22");
+    });
+    for(int i = 0; i < 500 && hot.isJitCompiled() != (jit != 0); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    assert(hot.isJitCompiled() == (jit != 0));
+    #endif
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**@file test_match_limits.cpp
+ *  Checks the match, depth and heap limits, see RegexMatch::setMatchLimit().
+ * @include test_match_limits.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static std::string repl(jp::NumSub const&, void*, void*){
+    return "#";
+}
+
+int main(){
+    std::string bad(20, 'a');
+    bad += "b";                 //catastrophic backtracking for (a+)+$
+    std::string deep;
+    for(int i = 0; i < 1000; ++i) deep += "ab";
+    deep += "c";
+
+    jp::Regex re("(a+)+$");
+    jp::RegexMatch rm(&re);
+    rm.setSubject(bad);
+    assert(rm.match() == 0);
+    assert(rm.getErrorNumber() == 0 && !rm.isLimitExceeded());
+
+    rm.setMatchLimit(1000);
+    assert(rm.getMatchLimit() == 1000);
+    assert(rm.match() == 0);
+    assert(rm.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT);
+    assert(rm.isLimitExceeded());
+    rm.resetErrors();
+    assert(rm.setSubject("aaa").match() == 1); //the context is reused
+    assert(!rm.isLimitExceeded());
+
+    //limits of the Regex object are the defaults
+    re.setMatchLimit(1000);
+    assert(re.getMatchLimit() == 1000);
+    jp::RegexMatch rm2(&re);
+    rm2.setSubject(bad).match();
+    assert(rm2.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT);
+    rm2.resetErrors();
+    rm2.setMatchLimit(100000000).match();
+    assert(rm2.getErrorNumber() == 0);
+    re.setMatchLimit(0);
+
+    //with a match context of our own, which isn't changed
+    pcre2_match_context_8* mc = pcre2_match_context_create_8(0);
+    pcre2_set_match_limit_8(mc, 1000);
+    jp::RegexMatch rm3(&re);
+    rm3.setSubject(bad).setMatchContext(mc).match();
+    assert(rm3.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT);
+    rm3.resetErrors();
+    rm3.setMatchLimit(100000000).match();
+    assert(rm3.getErrorNumber() == 0);
+    rm3.setMatchLimit(0).match();
+    assert(rm3.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT);
+
+    //depth and heap limits
+    jp::Regex rd("(a|b)*c");
+    jp::RegexMatch rm4(&rd);
+    rm4.setSubject(deep).setDepthLimit(10).match();
+    assert(rm4.getDepthLimit() == 10);
+    assert(rm4.getErrorNumber() == PCRE2_ERROR_DEPTHLIMIT && rm4.isLimitExceeded());
+    rm4.resetErrors();
+    rm4.setDepthLimit(0).setHeapLimit(1).match();
+    assert(rm4.getHeapLimit() == 1);
+    assert(rm4.getErrorNumber() == PCRE2_ERROR_HEAPLIMIT && rm4.isLimitExceeded());
+    rm4.resetErrors();
+    assert(rm4.setHeapLimit(0).match() == 1);
+
+    //replace
+    jp::RegexReplace rr(&re);
+    rr.setSubject(bad).setReplaceWith("#").setMatchLimit(1000);
+    assert(rr.replace() == bad);
+    assert(rr.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT && rr.isLimitExceeded());
+    rr.resetErrors();
+    assert(rr.setSubject("aaa").replace() == "#");
+    rr.setSubject(bad);
+    assert(rr.nreplace(jp::MatchEvaluator(repl)) == bad); //the limit is passed on
+    assert(rr.setSubject("aaa").nreplace(jp::MatchEvaluator(repl)) == "#");
+    rr.setSubject(bad);
+    jp::MatchEvaluator me(repl);
+    assert(me.setRegexObject(&re).setSubject(bad).setMatchLimit(1000).nreplace() == bad);
+    assert(me.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT && me.isLimitExceeded());
+    jp::VecStr subjects(3, bad), results;
+    subjects[1] = "xaa";
+    assert(rr.setModifier("g").replaceBatch(subjects, results) == 1);
+    assert(results[0] == bad && results[1] == "x#");
+    assert(rr.isLimitExceeded());
+
+    //reset() and clear() drop the limits
+    jp::RegexMatch rm5(&rd);
+    rm5.setMatchLimit(5).setDepthLimit(6).setHeapLimit(7).reset();
+    assert(rm5.getMatchLimit() == 0 && rm5.getDepthLimit() == 0 && rm5.getHeapLimit() == 0);
+    rm5.setRegexObject(&rd).setSubject(deep).setMatchLimit(5).clear();
+    assert(rm5.getMatchLimit() == 0);
+    assert(rm5.setRegexObject(&rd).setSubject(deep).match() == 1);
+    jp::RegexReplace rr5(&re);
+    rr5.setMatchLimit(5).setDepthLimit(6).setHeapLimit(7).reset();
+    assert(rr5.getMatchLimit() == 0 && rr5.getDepthLimit() == 0 && rr5.getHeapLimit() == 0);
+    rr5.setMatchLimit(5).clear();
+    assert(rr5.getMatchLimit() == 0);
+
+    #ifdef JPCRE2_USE_THREADS
+    //each thread has its own context
+    std::string text;
+    for(int i = 0; i < 200; ++i) text += "aaaa aaaaaaaaaaaab ";
+    jpcre2::ThreadPool pool(4);
+    jp::Regex rw("\\b(a+)+\\b ");
+    jp::RegexMatch prm(&rw);
+    prm.setSubject(text).setFindAll().setThreadPool(&pool).setChunkSize(256);
+    assert(prm.match() == 200);
+    assert(!prm.isLimitExceeded());
+    prm.setMatchLimit(100).match();
+    assert(prm.isLimitExceeded());
+    #endif
+
+    //JIT matches use the match limit too
+    uint32_t jit = 0;
+    pcre2_config_8(PCRE2_CONFIG_JIT, &jit);
+    if(jit){
+        jp::Regex rj("(a+)+$", "S");
+        jp::RegexMatch rmj(&rj);
+        rmj.setSubject(bad).setMatchLimit(1000).match();
+        assert(rmj.getErrorNumber() == PCRE2_ERROR_MATCHLIMIT);
+    }
+    pcre2_match_context_free_8(mc);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**@file test_match_result.cpp
+ *  Checks Regex::search() and MatchResult.
+ * @include test_match_result.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+#if __cplusplus >= 201103L
+#include <type_traits>
+//a temporary subject is not taken
+template<typename R, typename = decltype(std::declval<R const&>().search(std::string("x")))>
+static bool takesTemporary(int){ return true; }
+template<typename R>
+static bool takesTemporary(long){ return false; }
+#endif
+
+//the results outlive the Regex object
+static jp::MatchResult keysOf(std::string const& subject){
+    jp::Regex re("(?<key>\\w+)=(?<value>\\d+)?");
+    return re.search(subject, "g");
+}
+
+int main(){
+    std::string subject = "a=1 bb= ccc=333";
+    jp::MatchResult r = keysOf(subject);
+    assert(r.matched() && r.size() == 3 && r.getGroupCount() == 3 && r.getErrorNumber() == 0);
+    assert(r.getSubject() == &subject);
+    assert(r.get(1, "key") == "bb" && r.get(2, 2) == "333" && !r.isSet(1, 2) && r.get(1, "value") == "");
+    assert(r.getStartOffset(2) == 8 && r.getEndOffset(2, 1) == 11 && r.getGroupNumber("value") == 2);
+    long v = 0;
+    assert(r.parse(2, "value", v) == jpcre2::PARSE::OK && v == 333);
+
+    //copies share the code
+    jp::MatchResult c = r;
+    r = jp::MatchResult();
+    assert(!r.matched() && c.size() == 3 && c.get(0, "value") == "1");
+
+    //one match, modifiers of the Regex object, start offset
+    jp::Regex re("(\\d)", "i");
+    jp::MatchResult one = re.search(subject);
+    assert(one.size() == 1 && one.get(0, 1) == "1");
+    assert(re.search(&subject, "g", 5).size() == 3);
+    assert(re.search(&subject, "g", 5).get(0, 0) == "3");
+
+    //no match, errors
+    std::string none = "none";
+    jp::MatchResult nothing = re.search(none, "g");
+    assert(!nothing.matched() && nothing.getErrorNumber() == 0 && nothing.getErrorMessage().empty());
+    jp::MatchResult bad = re.search(subject, "", 100);
+    assert(!bad.matched() && bad.getErrorNumber() == PCRE2_ERROR_BADOFFSET && !bad.getErrorMessage().empty());
+    assert(!jp::Regex().search(subject).matched());
+    jp::Regex empty("x*");
+    jp::MatchResult null = empty.search((std::string const*) 0, "g"); //would match the empty subject
+    assert(null.empty() && !null.matched() && null.getErrorNumber() == 0);
+
+    #if __cplusplus >= 201103L
+    assert(!takesTemporary<jp::Regex>(0));
+
+    //cheap moves: the offsets are not copied
+    jp::MatchResult m = std::move(c);
+    PCRE2_SIZE const* offsets = m.getOffsets();
+    jp::MatchResult moved(std::move(m));
+    assert(moved.getOffsets() == offsets && moved.size() == 3 && m.empty());
+
+    #ifdef JPCRE2_USE_THREADS
+    //passed to another thread
+    std::string out;
+    std::thread t([&out](jp::MatchResult res){ out = res.get(2, "key"); }, moved);
+    t.join();
+    assert(out == "ccc");
+    #endif
+    #endif
+    return 0;
+}
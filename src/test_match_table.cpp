@@ -0,0 +1,88 @@
+/**@file test_match_table.cpp
+ *  Checks jpcre2::select::MatchTable, see RegexMatch::setMatchTable().
+ * @include test_match_table.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    std::string subject = "a=1, b=2, c, d=4";
+    jp::MatchTable table;
+    jp::VecNum vec_num;
+    {
+        jp::Regex re("(?<key>\\w)(?:=(?<value>\\d))?");
+        jp::RegexMatch rm(&re);
+        rm.setSubject(&subject).setFindAll().setMatchTable(&table).setNumberedSubstringVector(&vec_num);
+        assert(rm.getMatchTable() == &table);
+        assert(rm.match() == 4);
+    } //the table keeps the names
+
+    assert(table.size() == 4 && !table.empty());
+    assert(table.getGroupCount() == 3);
+    assert(table.getSubject() == &subject);
+    for(size_t i = 0; i < table.size(); ++i)
+        for(uint32_t g = 0; g < table.getGroupCount(); ++g)
+            assert(table.isSet(i, g) ? table.get(i, g) == vec_num[i][g] : table.get(i, g).empty());
+    assert(table.getStartOffset(1) == 5 && table.getEndOffset(1) == 8);
+    assert(table.getStartOffset(1, 2) == 7);
+    assert(table.getOffsets()[2 * 3 + 2] == 5); //match 1, group 1
+    assert(table.get(0, "key") == "a" && table.get(3, "value") == "4");
+    assert(!table.isSet(2, 2) && table.get(2, "value") == "");
+    assert(table.get(0, "nope") == "");
+    assert(table.getGroupNumber("key") == 1 && table.getGroupNumber("value") == 2);
+    assert(table.getGroupNumber("nope") == -1);
+
+    //copies share the names
+    jp::MatchTable copy(table);
+    table.clear();
+    assert(table.empty() && copy.size() == 4);
+    assert(copy.get(1, "value") == "2");
+    table = copy;
+    assert(table.get(3, "key") == "d");
+    #if __cplusplus >= 201103L
+    jp::MatchTable moved(std::move(copy));
+    assert(moved.size() == 4 && moved.get(1, 0) == "b=2");
+    #endif
+
+    //duplicate names: the first one that is set
+    jp::Regex rd("(?J)(?<n>x)|(?<n>y)");
+    jp::RegexMatch(&rd).setSubject(&subject).setMatchTable(&table).match();
+    assert(table.empty()); //the previous matches are removed
+    std::string xy = "yx";
+    jp::RegexMatch(&rd).setSubject(&xy).setMatchTable(&table).setFindAll().match();
+    assert(table.size() == 2);
+    assert(table.get(0, "n") == "y" && table.get(1, "n") == "x");
+    assert(table.getGroupNumber("n") == 1);
+
+    //a match data block with a bigger ovector
+    jp::Regex rs("(a)|(b)");
+    pcre2_match_data_8* md = pcre2_match_data_create_8(10, 0);
+    jp::RegexMatch(&rs).setSubject(&xy).setMatchTable(&table).setMatchDataBlock(md).match();
+    assert(table.size() == 0);
+    std::string ab = "ab";
+    jp::RegexMatch(&rs).setSubject(&ab).setMatchTable(&table).setMatchDataBlock(md).setFindAll().match();
+    assert(table.size() == 2 && table.getGroupCount() == 3);
+    assert(table.get(1, 2) == "b" && !table.isSet(1, 1));
+    pcre2_match_data_free_8(md);
+
+    #ifdef JPCRE2_USE_THREADS
+    std::string text;
+    for(int i = 0; i < 500; ++i) text += "k" + jpcre2::_tostdstring(i) + "=v ";
+    jpcre2::ThreadPool pool(4);
+    jp::Regex rp("(?<k>k\\d+)=(?<v>\\w)");
+    jp::MatchTable ptable;
+    jp::VecNum pnum;
+    jp::RegexMatch prm(&rp);
+    prm.setSubject(&text).setFindAll().setMatchTable(&ptable).setNumberedSubstringVector(&pnum)
+       .setThreadPool(&pool).setChunkSize(256);
+    assert(prm.match() == 500);
+    assert(ptable.size() == 500);
+    for(size_t i = 0; i < ptable.size(); ++i)
+        assert(ptable.get(i, "k") == pnum[i][1] && ptable.get(i, 0) == pnum[i][0]);
+    #endif
+    return 0;
+}
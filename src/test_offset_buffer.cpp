@@ -0,0 +1,119 @@
+/**@file test_offset_buffer.cpp
+ *  Checks RegexMatch::setOffsetBuffer() and that a match into it doesn't allocate.
+ * @include test_offset_buffer.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static size_t news = 0; //calls of operator new
+
+#if __cplusplus >= 201103L
+void* operator new(std::size_t n){
+#else
+void* operator new(std::size_t n) throw(std::bad_alloc){
+#endif
+    ++news;
+    void* p = std::malloc(n ? n : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+#if __cplusplus >= 201103L
+void* operator new(std::size_t n, std::nothrow_t const&) noexcept {
+#else
+void* operator new(std::size_t n, std::nothrow_t const&) throw() {
+#endif
+    ++news;
+    return std::malloc(n ? n : 1);
+}
+//GCC takes operator new and free() for a mismatched pair, but they are replaced together here.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+#if __cplusplus >= 201103L
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { std::free(p); }
+#else
+void operator delete(void* p) throw() { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) throw() { std::free(p); }
+#endif
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+static size_t pcre2_allocs = 0;
+
+static void* countedMalloc(PCRE2_SIZE size, void*){
+    ++pcre2_allocs;
+    return std::malloc(size);
+}
+
+static void countedFree(void* p, void*){
+    std::free(p);
+}
+
+static const PCRE2_SIZE U = PCRE2_UNSET;
+
+int main(){
+    std::string subject = "a=1 b=22 c=333 d";
+    jp::Regex re("(\\w)=(\\d+)|(\\w)$");
+    PCRE2_SIZE buf[2 * 4 * 3];
+    jp::RegexMatch rm(&re);
+    rm.setSubject(&subject).setFindAll().setOffsetBuffer(buf, 8, 3);
+
+    //the pattern has 4 groups, the buffer takes 3
+    assert(rm.match() == 4 && rm.getOffsetBufferCount() == 4 && rm.isOffsetBufferTruncated());
+    PCRE2_SIZE first[] = {0, 3, 0, 1, 2, 3};
+    PCRE2_SIZE last[] = {15, 16, U, U, U, U};
+    for(int i = 0; i < 6; ++i) assert(buf[i] == first[i] && buf[18 + i] == last[i]);
+    assert(buf[2 * 3 + 4] == 6 && buf[2 * 3 + 5] == 8);
+
+    //all groups fit
+    PCRE2_SIZE wide[2 * 8 * 5];
+    rm.setOffsetBuffer(wide, 8, 5);
+    assert(rm.match() == 4 && !rm.isOffsetBufferTruncated());
+    assert(wide[30] == 15 && wide[31] == 16 && wide[36] == 15 && wide[38] == U && wide[39] == U);
+
+    //no room for all matches: the search stops
+    jpcre2::VecOff soff;
+    rm.setOffsetBuffer(buf, 2, 3).setMatchStartOffsetVector(&soff);
+    assert(rm.match() == 2 && rm.getOffsetBufferCount() == 2 && rm.isOffsetBufferTruncated());
+    assert(soff.size() == 2 && buf[6] == 4);
+    rm.setOffsetBuffer(buf, 0, 3);
+    assert(rm.match() == 0 && rm.isOffsetBufferTruncated() && soff.empty());
+    rm.setOffsetBuffer(buf, 8, 4).setFindAll(false);
+    assert(rm.match() == 1 && !rm.isOffsetBufferTruncated());
+    rm.setSubject("-").setFindAll();
+    assert(rm.match() == 0 && rm.getOffsetBufferCount() == 0 && !rm.isOffsetBufferTruncated());
+    rm.setOffsetBuffer(0, 8);
+    assert(rm.setSubject(&subject).match() == 4 && rm.getOffsetBufferCount() == 0);
+
+    //no allocation once warmed up, with or without JIT
+    jp::GeneralContext* gc = jp::createGeneralContext(countedMalloc, countedFree, 0);
+    jp::setGeneralContext(gc);
+    char const* modifiers[] = {"", "S"};
+    for(int k = 0; k < 2; ++k){
+        jp::Regex hot("(?<key>\\w+)=(?<value>\\d+)", modifiers[k]);
+        jp::MatchData* md = pcre2_match_data_create_from_pattern_8(hot.getPcre2Code(), gc);
+        std::string line = "alpha=1 beta=22 gamma=333 delta=4444";
+        PCRE2_SIZE offsets[2 * 16 * 3];
+        jp::RegexMatch fast(&hot);
+        fast.setSubject(&line).setFindAll().setMatchDataBlock(md).setOffsetBuffer(offsets, 16, 3).setMatchLimit(100000);
+        assert(fast.match() == 4);
+        size_t n = news, a = pcre2_allocs;
+        for(int i = 0; i < 100; ++i) assert(fast.match() == 4);
+        assert(news == n && pcre2_allocs == a);
+        assert(offsets[2 * 3 * 3 + 4] == 32 && offsets[2 * 3 * 3 + 5] == 36);
+        pcre2_match_data_free_8(md);
+    }
+    jp::setGeneralContext(0);
+    jp::freeGeneralContext(gc);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/**@file test_parallel.cpp
+ *  Checks that chunk-parallel global match and replace give exactly the
+ *  same results as the sequential ones.
+ * @include test_parallel.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+#ifdef JPCRE2_USE_THREADS
+#include <chrono>
+
+typedef jpcre2::select<char> jp;
+
+static std::string makeSubject(){
+    std::string s;
+    for(int i = 0; i < 3000; ++i){
+        s += "line " + jpcre2::_tostdstring(i) + ": key=val" + jpcre2::_tostdstring(i % 7);
+        if(i % 5 == 0) s += " \xc3\xa9t\xc3\xa9";
+        s += (i % 11 == 0) ? "\r\n" : "\n";
+        if(i % 97 == 0) s += "\n";
+    }
+    return s;
+}
+
+static void checkMatch(jp::Regex& re, std::string const& subject, std::string const& mod, jpcre2::ThreadPool* pool){
+    jp::VecNum vn1, vn2;
+    jp::VecNas vs1, vs2;
+    jpcre2::VecOff so1, so2, eo1, eo2;
+    jp::RegexMatch rm(&re);
+    rm.setSubject(subject).setModifier(mod)
+      .setNumberedSubstringVector(&vn1).setNamedSubstringVector(&vs1)
+      .setMatchStartOffsetVector(&so1).setMatchEndOffsetVector(&eo1);
+    size_t c1 = rm.match();
+    rm.setThreadPool(pool).setChunkSize(64)
+      .setNumberedSubstringVector(&vn2).setNamedSubstringVector(&vs2)
+      .setMatchStartOffsetVector(&so2).setMatchEndOffsetVector(&eo2);
+    size_t c2 = rm.match();
+    assert(c1 == c2);
+    assert(vn1 == vn2);
+    assert(vs1 == vs2);
+    assert(so1 == so2);
+    assert(eo1 == eo2);
+}
+
+static void checkReplace(jp::Regex& re, std::string const& subject, std::string const& repl, jpcre2::ThreadPool* pool){
+    size_t c1 = 0, c2 = 0;
+    jp::RegexReplace rr(&re);
+    rr.setSubject(subject).setReplaceWith(repl).setModifier("g").setReplaceCounter(&c1);
+    std::string r1 = rr.replace();
+    rr.setThreadPool(pool).setChunkSize(64).setReplaceCounter(&c2);
+    std::string r2 = rr.replace();
+    assert(c1 == c2);
+    assert(r1 == r2);
+}
+
+int main(){
+    jpcre2::ThreadPool pool(4);
+    std::string subject = makeSubject();
+
+    char const* patterns[] = {
+        "(?<key>\\w+)=(?<val>\\w+)",
+        "^line \\d+",           //multiline
+        "x*",                   //empty matches
+        "\\d+\\s+\\w",          //spans lines
+        "val6.*?line 1\\d",     //spans lines with dotall
+        ".{0,40}",
+        "\\Kkey",
+        "(*CRLF)$",
+        "\\w\\b",
+        "\xc3\xa9",
+    };
+    char const* mods[] = {"", "m", "", "", "s", "", "", "m", "u", "u"};
+    for(size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); ++i){
+        jp::Regex re(patterns[i], mods[i]);
+        assert(re);
+        checkMatch(re, subject, "g", &pool);
+        checkReplace(re, subject, "[$0]", &pool);
+    }
+
+    //with a start offset
+    jp::Regex re("\\d+");
+    jp::VecNum vn1, vn2;
+    jp::RegexMatch rm(&re);
+    size_t c1 = rm.setSubject(subject).setFindAll().setStartOffset(1000).setNumberedSubstringVector(&vn1).match();
+    size_t c2 = rm.setThreadPool(&pool).setChunkSize(64).setNumberedSubstringVector(&vn2).match();
+    assert(c1 == c2 && vn1 == vn2);
+    assert(re.initReplace().setSubject(subject).setReplaceWith("#").setModifier("g").setStartOffset(1000).replace() ==
+           re.initReplace().setSubject(subject).setReplaceWith("#").setModifier("g").setStartOffset(1000)
+                           .setThreadPool(&pool).setChunkSize(64).replace());
+
+    //invalid UTF is reported as by the sequential search
+    jp::Regex re3("\\w", "u");
+    std::string bad = subject + "\xff";
+    jp::RegexMatch rm3(&re3), prm3(&re3);
+    rm3.setSubject(bad).setFindAll();
+    prm3.setSubject(bad).setFindAll().setThreadPool(&pool).setChunkSize(64);
+    assert(rm3.match() == prm3.match() && rm3.getErrorNumber() != 0 && rm3.getErrorNumber() == prm3.getErrorNumber());
+    jp::RegexReplace rr3(&re3), prr3(&re3);
+    rr3.setSubject(bad).setReplaceWith("#").setModifier("g");
+    prr3.setSubject(bad).setReplaceWith("#").setModifier("g").setThreadPool(&pool).setChunkSize(64);
+    assert(rr3.replace() == prr3.replace() && rr3.getErrorNumber() != 0 && rr3.getErrorNumber() == prr3.getErrorNumber());
+    assert(re3.initReplace().setSubject(subject).setReplaceWith("\xff").setModifier("g").setThreadPool(&pool)
+              .setChunkSize(64).replace() == subject); //invalid replacement
+
+    //a chunk stops at its first failed search, it does not retry at each character
+    jp::Regex re4("val6.*?line 1\\d", "s");
+    jp::RegexMatch rm4(&re4);
+    rm4.setSubject(subject).setFindAll().addPcre2Option(PCRE2_NOTBOL);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    c1 = rm4.match();
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    c2 = rm4.setThreadPool(&pool).setChunkSize(64).match();
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    assert(c1 == c2);
+    assert(t1 - t0 < std::chrono::seconds(2));
+    assert(t2 - t1 < std::chrono::seconds(2));
+
+    //anchored and \G patterns are done sequentially
+    jp::Regex re2("\\Gline \\d+:[^\\n]*\\n");
+    jp::RegexMatch rm2(&re2);
+    c1 = rm2.setSubject(subject).setFindAll().match();
+    c2 = rm2.setThreadPool(&pool).setChunkSize(64).match();
+    assert(c1 == 1 && c2 == 1);
+
+    //MatchEvaluator
+    jp::MatchEvaluator me([](jp::NumSub const& m, void*, void*){ return "<" + m[0] + ">"; });
+    std::string r1 = re.initReplace().setSubject(subject).setModifier("g").nreplace(me);
+    std::string r2 = re.initReplace().setSubject(subject).setModifier("g").setThreadPool(&pool).setChunkSize(64).nreplace(me);
+    assert(r1 == r2);
+
+    //parallelFor rethrows
+    bool thrown = false;
+    try {
+        pool.parallelFor(10, [](size_t i){ if(i == 7) throw i; });
+    } catch(size_t i){
+        thrown = (i == 7);
+    }
+    assert(thrown);
+    return 0;
+}
+
+#else
+
+int main(){
+    return 0;
+}
+
+#endif
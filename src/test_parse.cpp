@@ -0,0 +1,108 @@
+/**@file test_parse.cpp
+ *  Checks jpcre2::parse() and MatchTable::parse().
+ * @include test_parse.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include <cstring>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+template<typename T>
+static int parseStr(char const* s, T& v){
+    return jpcre2::parse(s, s + std::strlen(s), v);
+}
+
+struct Metric {
+    std::string host;
+    long count;
+    double value;
+    long stamp; //seconds of the day
+};
+
+//hh:mm:ss
+static int parseTime(char const* first, char const* last, Metric& m){
+    int h, mi, s;
+    if(last - first != 8 || first[2] != ':' || first[5] != ':') return jpcre2::PARSE::INVALID;
+    if(jpcre2::parse(first, first + 2, h) || jpcre2::parse(first + 3, first + 5, mi) || jpcre2::parse(first + 6, last, s))
+        return jpcre2::PARSE::INVALID;
+    if(h > 23 || mi > 59 || s > 59) return jpcre2::PARSE::OUT_OF_RANGE;
+    m.stamp = h * 3600L + mi * 60 + s;
+    return jpcre2::PARSE::OK;
+}
+
+static jp::Field<Metric> const fields[] = {
+    {"host", jp::parseMember<Metric, std::string, &Metric::host>},
+    {"count", jp::parseMember<Metric, long, &Metric::count>},
+    {"value", jp::parseMember<Metric, double, &Metric::value>},
+    {"time", parseTime},
+};
+
+int main(){
+    //integers
+    int i = 7;
+    assert(parseStr("123", i) == jpcre2::PARSE::OK && i == 123);
+    assert(parseStr("-2147483648", i) == jpcre2::PARSE::OK && i == -2147483647 - 1);
+    assert(parseStr("2147483648", i) == jpcre2::PARSE::OUT_OF_RANGE && i == -2147483647 - 1);
+    assert(parseStr("-2147483649", i) == jpcre2::PARSE::OUT_OF_RANGE);
+    assert(parseStr("", i) == jpcre2::PARSE::INVALID && parseStr("-", i) == jpcre2::PARSE::INVALID);
+    assert(parseStr("+1", i) == jpcre2::PARSE::INVALID && parseStr(" 1", i) == jpcre2::PARSE::INVALID);
+    assert(parseStr("12a", i) == jpcre2::PARSE::INVALID && parseStr("99999999999x", i) == jpcre2::PARSE::INVALID);
+    unsigned char uc;
+    assert(parseStr("255", uc) == jpcre2::PARSE::OK && uc == 255 && parseStr("256", uc) == jpcre2::PARSE::OUT_OF_RANGE);
+    unsigned long ul;
+    assert(parseStr("-1", ul) == jpcre2::PARSE::INVALID && parseStr("0", ul) == jpcre2::PARSE::OK && ul == 0);
+    short sh;
+    assert(parseStr("-32768", sh) == jpcre2::PARSE::OK && sh == -32768 && parseStr("32768", sh) == jpcre2::PARSE::OUT_OF_RANGE);
+
+    //floating point
+    double d = 0;
+    assert(parseStr("2.5e3", d) == jpcre2::PARSE::OK && d == 2500);
+    assert(parseStr("-.5", d) == jpcre2::PARSE::OK && d == -0.5);
+    assert(parseStr("1e999", d) == jpcre2::PARSE::OUT_OF_RANGE && d == -0.5);
+    assert(parseStr("0x10", d) == jpcre2::PARSE::INVALID && parseStr("1.5.", d) == jpcre2::PARSE::INVALID);
+    assert(parseStr("+1", d) == jpcre2::PARSE::INVALID && parseStr(" 1", d) == jpcre2::PARSE::INVALID);
+    assert(parseStr("inf", d) == jpcre2::PARSE::OK && d > 1e308);
+    float f;
+    assert(parseStr("0.25", f) == jpcre2::PARSE::OK && f == 0.25f && parseStr("1e39", f) == jpcre2::PARSE::OUT_OF_RANGE);
+    std::string longer(200, '1');
+    assert(parseStr(longer.c_str(), d) == jpcre2::PARSE::INVALID);
+
+    //other character types
+    wchar_t const w[] = L"-42";
+    long l;
+    assert(jpcre2::parse(w, w + 3, l) == jpcre2::PARSE::OK && l == -42);
+    assert(jpcre2::parse(w, w + 3, d) == jpcre2::PARSE::OK && d == -42);
+
+    //match table
+    std::string subject = "web1 count=12 value=0.5 at 10:00:01\n"
+                          "web2 count=x value=1e999 at 25:00:00\n"
+                          "db count=7 value=2 at 23:59:59";
+    jp::Regex re("^(?<host>\\w+) count=(?<count>\\w+) value=(?<value>\\S+) at (?<time>\\S+)(?<none>!)?$", "m");
+    jp::MatchTable table;
+    assert(jp::RegexMatch(&re).setSubject(&subject).setMatchTable(&table).setFindAll().match() == 3);
+    long count = 0;
+    assert(table.parse(0, 2, count) == jpcre2::PARSE::OK && count == 12);
+    assert(table.parse(1, "count", count) == jpcre2::PARSE::INVALID && count == 12);
+    assert(table.parse(2, "count", count) == jpcre2::PARSE::OK && count == 7);
+    assert(table.parse(2, "none", count) == jpcre2::PARSE::UNSET && table.parse(2, "other", count) == jpcre2::PARSE::UNSET);
+    assert(table.parse(2, 9, count) == jpcre2::PARSE::UNSET);
+    std::string host;
+    assert(table.parse(2, 0, host) == jpcre2::PARSE::OK && host == "db count=7 value=2 at 23:59:59");
+
+    //fields
+    size_t const n = sizeof(fields) / sizeof(fields[0]);
+    int errors[n];
+    Metric m = {"", 0, 0, 0};
+    assert(table.parse(0, m, fields, n, errors) == 0);
+    assert(m.host == "web1" && m.count == 12 && m.value == 0.5 && m.stamp == 36001);
+    for(size_t k = 0; k < n; ++k) assert(errors[k] == jpcre2::PARSE::OK);
+    assert(table.parse(1, m, fields, n, errors) == 3);
+    assert(m.host == "web2" && m.count == 12 && m.value == 0.5 && m.stamp == 36001);
+    assert(errors[0] == jpcre2::PARSE::OK && errors[1] == jpcre2::PARSE::INVALID
+           && errors[2] == jpcre2::PARSE::OUT_OF_RANGE && errors[3] == jpcre2::PARSE::OUT_OF_RANGE);
+    assert(table.parse(2, m, fields, n) == 0 && m.stamp == 86399 && m.value == 2);
+    return 0;
+}
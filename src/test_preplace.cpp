@@ -0,0 +1,64 @@
+/**@file test_preplace.cpp
+ *  Checks the in-place RegexReplace::preplace() against RegexReplace::replace().
+ * @include test_preplace.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static void check(char const* pat, char const* pmod, std::string const& subject, char const* repl, char const* mod,
+                  size_t offset = 0){
+    jp::Regex re(pat, pmod);
+    assert(re.getPcre2Code() != 0);
+    size_t c1 = 0, c2 = 0;
+    jp::RegexReplace rr(&re);
+    rr.setSubject(subject).setReplaceWith(repl).setModifier(mod).setStartOffset(offset);
+    std::string result = rr.setReplaceCounter(&c1).replace();
+    int err = rr.getErrorNumber();
+    rr.resetErrors();
+    std::string s = subject;
+    rr.setSubject(&s).setReplaceCounter(&c2).preplace();
+    assert(rr.getErrorNumber() == err);
+    assert(s == result);
+    assert(c1 == c2);
+}
+
+int main(){
+    std::string subject;
+    for(int i = 0; i < 200; ++i){
+        subject += "card=4111" + jpcre2::_tostdstring(i * 7919) + " name=\xc3\xa0l\xc3\xa9x" + jpcre2::_tostdstring(i);
+        subject += (i % 7 == 0) ? "\r\n" : "\n";
+    }
+    check("\\d", "", subject, "*", "g");                    //same length
+    check("\\d+", "", subject, "", "g");                    //shorter
+    check("(?<=card=\\d{4})\\d+", "", subject, "****", "g"); //lookbehind
+    check("(?<=\\d)\\d", "", subject, "", "g");             //lookbehind into the replaced text
+    check("\\d\\b", "", subject, "", "g");
+    check("(*CRLF)^\\w", "m", subject, "", "g");
+    check("\\w+", "", subject, "<$0>", "g");                //longer
+    check("\\d+", "", subject, "$0$0", "g", 100);
+    check("x*", "", subject, "-", "g");                     //empty matches
+    check(".", "u", subject, "[$0]", "g");
+    check("\\d", "u", subject, "\xc3\xa9", "g");            //longer, multibyte
+    check("[\\x{e0}\\x{e9}]", "u", subject, "", "g");
+    check(".", "u", "ab\xff", "x", "g");                    //error: invalid UTF-8
+    check("\\w+", "", subject, "${0:+x}", "gE");
+    check("(?<n>\\d)(a)?", "", subject, "${2:-}${n}", "gE");
+    check("\\d+", "", subject, "#", "");
+    check("nomatch", "", subject, "x", "g");
+    check("\\d+", "", subject, "$9", "g");                  //error: unknown group
+    check("\\d(\\d)?", "", subject, "$1", "g");              //error after some matches: unset group
+    check("\\d+", "", "", "x", "g");
+    //shorter in the end, longer on the way (kept aside until there's room)
+    check("a|bbbb", "", std::string(10, 'a') + std::string(40, 'b'), "xx", "g");
+
+    //Regex shorthand
+    jp::Regex re("\\d");
+    std::string s = subject;
+    assert(re.preplace(&s, "", "g") > 0);
+    assert(s == re.replace(subject, "", "g"));
+    return 0;
+}
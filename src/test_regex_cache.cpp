@@ -0,0 +1,99 @@
+/**@file test_regex_cache.cpp
+ *  Checks RegexCache.
+ * @include test_regex_cache.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+#ifdef JPCRE2_USE_THREADS
+#include <thread>
+#endif
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    jp::RegexCache cache;
+    jp::Regex a, b;
+    a.setCache(&cache).compile("(\\w+)\\d", "i");
+    b.setCache(&cache).compile("(\\w+)\\d", "i");
+    assert(a.getPcre2Code() != 0);
+    assert(a.getPcre2Code() == b.getPcre2Code());
+    assert(cache.getHits() == 1 && cache.getMisses() == 1 && cache.size() == 1);
+    assert(cache.getMemory() > 0);
+
+    //different options, different code
+    b.compile("(\\w+)\\d", "");
+    assert(a.getPcre2Code() != b.getPcre2Code());
+    b.compile("(\\w+)\\d", "S");
+    assert(a.getPcre2Code() != b.getPcre2Code());
+    jp::Regex c;
+    c.setCache(&cache).setNewLine(PCRE2_NEWLINE_CRLF).compile("(\\w+)\\d", "i");
+    assert(a.getPcre2Code() != c.getPcre2Code());
+    c.resetCharacterTables().compile();
+    assert(a.getPcre2Code() != c.getPcre2Code());
+    assert(cache.size() == 5);
+
+    //failed compiles are not cached
+    c.compile("(");
+    assert(c.getPcre2Code() == 0);
+    assert(cache.size() == 5);
+
+    //copies keep the cache
+    jp::Regex d(a);
+    d.compile("(\\w+)\\d", "i");
+    assert(d.getPcre2Code() == a.getPcre2Code());
+
+    //code in use outlives the cache
+    {
+        jp::RegexCache tmp;
+        d.setCache(&tmp).compile("x+");
+        tmp.clear();
+        assert(tmp.size() == 0);
+        d.setCache(0);
+    }
+    assert(d.match("axxb", "g") == 1);
+
+    //deferred JIT compilation is part of the key
+    uint32_t jit = 0;
+    pcre2_config_8(PCRE2_CONFIG_JIT, &jit);
+    jp::RegexCache jc;
+    jp::Regex deferred, eager, plain, plain2;
+    deferred.setCache(&jc).setJitThreshold(1000).compile("(\\d+)x", "S");
+    eager.setCache(&jc).compile("(\\d+)x", "S");
+    assert(jc.size() == 2 && deferred.getPcre2Code() != eager.getPcre2Code());
+    assert(!deferred.isJitCompiled() && eager.isJitCompiled() == (jit != 0));
+    plain.setCache(&jc).compile("(\\d+)x");
+    plain2.setCache(&jc).setJitThreshold(1000).compile("(\\d+)x"); //no JIT: the threshold doesn't matter
+    assert(jc.size() == 3 && plain2.getPcre2Code() == plain.getPcre2Code());
+
+    //eviction
+    jp::RegexCache small(4096, 1);
+    jp::Regex e;
+    e.setCache(&small);
+    for(int i = 0; i < 100; ++i) e.compile("pattern" + jpcre2::_tostdstring(i) + "\\d+[a-z]*");
+    assert(small.getMemory() <= 4096);
+    assert(small.size() > 0 && small.size() < 100);
+    e.compile("pattern99\\d+[a-z]*");
+    assert(small.getHits() == 1);
+    e.compile("pattern0\\d+[a-z]*");
+    assert(small.getHits() == 1);
+
+    #ifdef JPCRE2_USE_THREADS
+    jp::RegexCache shared;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; ++t){
+        threads.push_back(std::thread([&shared](){
+            for(int i = 0; i < 200; ++i){
+                jp::Regex re;
+                re.setCache(&shared).compile("p" + jpcre2::_tostdstring(i % 20) + "(\\d+)", "S");
+                assert(re.match("xp" + jpcre2::_tostdstring(i % 20) + "123") == 1);
+            }
+        }));
+    }
+    for(size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    assert(shared.size() == 20);
+    assert(shared.getHits() + shared.getMisses() == 1600);
+    #endif
+    return 0;
+}
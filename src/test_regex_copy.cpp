@@ -0,0 +1,60 @@
+/**@file test_regex_copy.cpp
+ *  Checks that copies of a Regex share the compiled code.
+ * @include test_regex_copy.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include <clocale>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    jp::Regex* re = new jp::Regex("(\\w+)\\s(\\d+)", "iS");
+    assert(re->getPcre2Code() != 0);
+    jp::Regex copy(*re);
+    assert(copy.getPcre2Code() == re->getPcre2Code());
+    jp::Regex assigned;
+    assigned = copy;
+    assert(assigned.getPcre2Code() == re->getPcre2Code());
+    assigned = assigned;
+    assert(assigned.getPcre2Code() == re->getPcre2Code());
+
+    //the code outlives the object it was compiled by
+    delete re;
+    jp::VecNum vn;
+    assert(copy.initMatch().setSubject("abc 12 def 345").setModifier("g").setNumberedSubstringVector(&vn).match() == 2);
+    assert(vn[1][2] == "345");
+
+    //compile() creates new code only for the object that calls it
+    jp::Pcre2Code const* code = copy.getPcre2Code();
+    assigned.compile("\\d+");
+    assert(assigned.getPcre2Code() != code);
+    assert(copy.getPcre2Code() == code);
+    assert(assigned.match("abc 12") == 1 && copy.match("abc 12") == 1);
+
+    //the tables live as long as the code
+    std::setlocale(LC_CTYPE, "");
+    jp::Regex* tre = new jp::Regex();
+    tre->resetCharacterTables().compile("[[:alpha:]]+");
+    jp::Regex tcopy = *tre;
+    tre->resetCharacterTables();
+    delete tre;
+    assert(tcopy.match("ab cd", "g") == 2);
+
+    //failed compile
+    jp::Regex bad("(");
+    jp::Regex bcopy(bad);
+    assert(bcopy.getPcre2Code() == 0);
+    assert(bcopy.getErrorNumber() == bad.getErrorNumber());
+
+    #if __cplusplus >= 201103L
+    //move
+    jp::Regex moved(std::move(copy));
+    assert(moved.getPcre2Code() == code && copy.getPcre2Code() == 0);
+    std::vector<jp::Regex> vec(100, moved);
+    for(size_t i = 0; i < vec.size(); ++i) assert(vec[i].getPcre2Code() == code);
+    #endif
+    return 0;
+}
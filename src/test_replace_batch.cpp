@@ -0,0 +1,76 @@
+/**@file test_replace_batch.cpp
+ *  Checks RegexReplace::replaceBatch() against RegexReplace::replace().
+ * @include test_replace_batch.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static jp::VecStr makeSubjects(){
+    jp::VecStr subjects;
+    for(unsigned i = 0; i < 500; ++i){
+        std::string s = "id=" + jpcre2::_tostdstring(i) + " card=4111" + jpcre2::_tostdstring(i * 7919u);
+        if(i % 3 == 0) s += " card=5500" + jpcre2::_tostdstring(i);
+        if(i % 50 == 0) s = "";
+        subjects.push_back(s);
+    }
+    return subjects;
+}
+
+static void checkBatch(jp::RegexReplace& rr, jp::VecStr const& subjects, jp::VecStr const& results, size_t count){
+    size_t total = 0;
+    for(size_t i = 0; i < subjects.size(); ++i){
+        size_t c = 0;
+        std::string r = jp::RegexReplace(rr).setSubject(subjects[i]).setReplaceCounter(&c).replace();
+        assert(r == results[i]);
+        total += c;
+    }
+    assert(total == count);
+}
+
+int main(){
+    jp::Regex re("card=(\\d{4})\\d+");
+    jp::VecStr subjects = makeSubjects();
+    jp::VecStr results;
+
+    jp::RegexReplace rr(&re);
+    rr.setReplaceWith("card=$1****").setModifier("g");
+    size_t count = rr.replaceBatch(subjects, results);
+    assert(results.size() == subjects.size());
+    assert(count > subjects.size());
+    assert(results[1] == "id=1 card=4111****");
+    checkBatch(rr, subjects, results, count);
+
+    //results are reused
+    count = rr.setModifier("").replaceBatch(subjects, results);
+    checkBatch(rr, subjects, results, count);
+
+    //small initial buffer grows as needed
+    count = rr.setModifier("g").setBufferSize(1).replaceBatch(subjects, results);
+    checkBatch(rr, subjects, results, count);
+
+    //in-place
+    jp::VecStr inplace = subjects;
+    assert(re.replaceBatch(inplace, inplace, "card=$1****", "g") == count);
+    assert(inplace == results);
+
+    //error keeps the subject
+    jp::RegexReplace bad(&re);
+    bad.setReplaceWith("$9").setModifier("g").replaceBatch(subjects, results);
+    assert(bad.getErrorNumber() < 0);
+    assert(results == subjects);
+
+    #ifdef JPCRE2_USE_THREADS
+    jpcre2::ThreadPool pool(4);
+    jp::VecStr presults(3, std::string(100, 'x'));
+    size_t pcount = rr.setThreadPool(&pool).replaceBatch(subjects, presults);
+    assert(pcount == count);
+    assert(presults == inplace);
+    assert(re.replaceBatch(subjects, presults, "card=$1****", "g", &pool) == count);
+    assert(presults == inplace);
+    #endif
+    return 0;
+}
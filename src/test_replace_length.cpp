@@ -0,0 +1,52 @@
+/**@file test_replace_length.cpp
+ *  Checks RegexReplace::replaceLength() against RegexReplace::replace().
+ * @include test_replace_length.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+static void check(char const* pat, char const* pmod, std::string const& subject, char const* repl, char const* mod,
+                  size_t offset = 0){
+    jp::Regex re(pat, pmod);
+    assert(re.getPcre2Code() != 0);
+    size_t c1 = 0, c2 = 0;
+    jp::RegexReplace rr(&re);
+    rr.setSubject(subject).setReplaceWith(repl).setModifier(mod).setStartOffset(offset);
+    std::string result = rr.setReplaceCounter(&c1).replace();
+    int err = rr.getErrorNumber();
+    rr.resetErrors();
+    size_t length = rr.setReplaceCounter(&c2).replaceLength();
+    assert(rr.getErrorNumber() == err);
+    assert(length == result.length());
+    assert(c1 == c2);
+}
+
+int main(){
+    std::string subject = "I have 123 apples and 4567 oranges\r\nand 89 \xc3\xa0 pears.";
+    check("\\d+", "", subject, "<$0>", "g");
+    check("\\d+", "", subject, "<$0>", "");
+    check("\\d+", "", subject, "", "g");
+    check("\\d+", "", subject, "<$0>", "g", 12);
+    check("x*", "", subject, "-", "g");
+    check("(*CRLF)$", "m", subject, "|", "g");
+    check(".", "u", subject, "[$0]", "g");
+    check("(?<n>\\d)(\\w)?", "", subject, "${2:-none}${n}", "gE");
+    check("nomatch", "", subject, "x", "g");
+    check("\\d+", "", "", "x", "g");
+    check("\\d+", "", subject, "$9", "g");      //error: unknown group
+    check("\\d+", "", subject, "x", "g", 1000); //error: bad offset
+
+    //size the buffer for the real replace
+    jp::Regex re("\\w+");
+    jp::RegexReplace rr(&re);
+    size_t count = 0;
+    rr.setSubject(subject).setReplaceWith("{$0}").setModifier("g").setReplaceCounter(&count);
+    size_t length = rr.replaceLength();
+    assert(count == 10);
+    assert(rr.setBufferSize(length).replace().length() == length);
+    return 0;
+}
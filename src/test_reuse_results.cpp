@@ -0,0 +1,77 @@
+/**@file test_reuse_results.cpp
+ *  Checks RegexMatch::setReuseResults().
+ * @include test_reuse_results.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+
+int main(){
+    std::string a(100, 'a'), b(100, 'b');
+    std::string s1 = "k=" + a + " k=" + b + " x=1";
+    std::string s2 = "k=" + b + " k=" + a;
+
+    jp::Regex re("(?<key>\\w)=(?<value>\\w+)");
+    jp::VecNum vn, vn2;
+    jp::VecNas vs, vs2;
+    jp::VecNtN vt;
+    jp::RegexMatch rm(&re), plain(&re);
+    rm.setNumberedSubstringVector(&vn).setNamedSubstringVector(&vs).setNameToNumberMapVector(&vt)
+      .setFindAll().setReuseResults();
+    plain.setNumberedSubstringVector(&vn2).setNamedSubstringVector(&vs2).setFindAll();
+    assert(rm.getReuseResults() && !plain.getReuseResults());
+
+    assert(rm.setSubject(&s1).match() == 3);
+    assert(plain.setSubject(&s1).match() == 3);
+    assert(vn == vn2 && vs == vs2);
+    assert(vt.size() == 3 && vt[2]["value"] == 2);
+
+    //the strings of the previous match are filled in place
+    char const* p0 = vn[0][2].data();
+    char const* p1 = vn[1][2].data();
+    assert(rm.setSubject(&s2).match() == 2);
+    assert(plain.setSubject(&s2).match() == 2);
+    assert(vn.size() == 2 && vn == vn2 && vs == vs2 && vt.size() == 2);
+    assert((vn[0][2].data() == p0 || vn[0][2].data() == p1) && (vn[1][2].data() == p0 || vn[1][2].data() == p1));
+    assert(vs[1]["value"] == a);
+
+    //more matches than before
+    assert(rm.setSubject(&s1).match() == 3 && plain.setSubject(&s1).match() == 3);
+    assert(vn == vn2 && vs == vs2);
+
+    //another pattern: the names of the previous one are not kept
+    jp::Regex re2("(?<other>\\w)=");
+    rm.setRegexObject(&re2);
+    plain.setRegexObject(&re2);
+    assert(rm.match() == 3 && plain.match() == 3);
+    assert(vn == vn2 && vs == vs2);
+    assert(vs[0].size() == 1 && vs[0].count("key") == 0 && vt[0].size() == 1);
+
+    //the same Regex compiled again with another name (the new code may get the address of the old one)
+    jp::Regex same;
+    jp::VecNas sv;
+    jp::RegexMatch srm(&same);
+    srm.setSubject("x").setNamedSubstringVector(&sv).setReuseResults();
+    for(int i = 0; i < 4; ++i){
+        same.compile(i % 2 ? "(?<b>x)" : "(?<a>x)");
+        assert(srm.match() == 1 && sv[0].size() == 1 && sv[0].count(i % 2 ? "b" : "a") == 1);
+    }
+
+    //no match
+    assert(rm.setSubject("").match() == 0);
+    assert(vn.empty() && vs.empty() && vt.empty());
+
+    rm.shrinkResults();
+    assert(vn.capacity() == 0);
+    assert(rm.setSubject(&s2).match() == 2 && vn[1][1] == "k");
+
+    //MatchEvaluator
+    jp::MatchEvaluator me(jp::callback::eraseFill);
+    me.setRegexObject(&re).setSubject(&s1).setFindAll().setReuseResults();
+    assert(me.nreplace() == "  ");
+    assert(me.setSubject(&s2).nreplace() == " ");
+    return 0;
+}
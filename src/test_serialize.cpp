@@ -0,0 +1,91 @@
+/**@file test_serialize.cpp
+ *  Checks Regex::serialize() and Regex::deserialize().
+ * @include test_serialize.cpp
+ * @author [Md Jahidul Hamid](https://github.com/neurobin)
+ * */
+
+#include <cassert>
+#include <cstdio>
+#include "jpcre2.hpp"
+
+typedef jpcre2::select<char> jp;
+typedef jpcre2::select<wchar_t> jpw;
+
+int main(){
+    jpcre2::ModifierTable mdt;
+    jpcre2::Uint copts[] = {0, PCRE2_CASELESS}; //'f' does nothing
+    jpcre2::Uint mopts[] = {jpcre2::FIND_ALL};
+    mdt.setCompileModifierTable("fi", copts);
+    mdt.setMatchModifierTable("G", mopts);
+
+    std::vector<jp::Regex> regexes(5);
+    regexes[0].compile("(?<y>\\d{4})-(\\d\\d)", "S");
+    regexes[1].setModifierTable(&mdt).compile("abc", "i");
+    regexes[2].setNewLine(PCRE2_NEWLINE_CRLF).compile("^x$", "m");
+    regexes[3].compile("(");  //not compiled
+    regexes[4].compile("\\w+", "uS");
+    std::vector<unsigned char> bytes;
+    assert(jp::Regex::serialize(regexes, bytes) == 0);
+    assert(!bytes.empty());
+
+    std::vector<jp::Regex> loaded;
+    std::vector<jpcre2::ModifierTable> modtabs;
+    assert(jp::Regex::deserialize(bytes, loaded, &modtabs) == 0);
+    assert(loaded.size() == 5);
+    assert(modtabs.size() == 1);
+    for(size_t i = 0; i < loaded.size(); ++i){
+        assert(loaded[i].getPattern() == regexes[i].getPattern());
+        assert(loaded[i].getPcre2Option() == regexes[i].getPcre2Option());
+        assert(loaded[i].getJpcre2Option() == regexes[i].getJpcre2Option());
+        assert((loaded[i].getPcre2Code() == 0) == (regexes[i].getPcre2Code() == 0));
+    }
+    //JIT compiled on first match
+    uint32_t jit = 0;
+    size_t jit_size = 1;
+    pcre2_config_8(PCRE2_CONFIG_JIT, &jit);
+    pcre2_pattern_info_8(loaded[0].getPcre2Code(), PCRE2_INFO_JITSIZE, &jit_size);
+    assert(jit_size == 0);
+    jp::VecNum vn;
+    assert(loaded[0].initMatch().setSubject("2019-04 2020-12").setFindAll().setNumberedSubstringVector(&vn).match() == 2);
+    assert(vn[1][1] == "2020" && vn[1][2] == "12");
+    pcre2_pattern_info_8(loaded[0].getPcre2Code(), PCRE2_INFO_JITSIZE, &jit_size);
+    assert(jit_size > 0 || !jit);
+    assert(loaded[1].getModifierTable() == &modtabs[0]);
+    assert(loaded[1].match("xABCx ABC", "G") == 2);
+    assert(loaded[1].getModifier() == "i");
+    assert(loaded[2].getNewLine() == PCRE2_NEWLINE_CRLF);
+    assert(loaded[2].match("a\r\nx\r\nb") == 1);
+    assert(loaded[3].getPcre2Code() == 0);
+    assert(loaded[4].replace("ab cd", "<$0>", "g") == "<ab> <cd>");
+    //recompile works
+    loaded[4].compile();
+    assert(loaded[4].match("ab cd", "g") == 2);
+
+    //without modifier tables
+    assert(jp::Regex::deserialize(bytes, loaded) == 0);
+    assert(loaded[1].getModifierTable() == 0);
+
+    //invalid data leaves the vector unchanged
+    std::vector<unsigned char> bad(bytes.begin(), bytes.begin() + bytes.size() / 2);
+    assert(jp::Regex::deserialize(bad, loaded) == PCRE2_ERROR_BADSERIALIZEDDATA);
+    assert(loaded.size() == 5);
+    bad = bytes;
+    bad[0] = 'X';
+    assert(jp::Regex::deserialize(bad, loaded) == PCRE2_ERROR_BADSERIALIZEDDATA);
+    std::vector<jpw::Regex> wloaded;
+    assert(jpw::Regex::deserialize(bytes, wloaded) == PCRE2_ERROR_BADSERIALIZEDDATA);
+
+    //file
+    char const* path = "test_serialize.bin";
+    assert(jp::Regex::serializeToFile(regexes, path) == 0);
+    assert(jp::Regex::deserializeFromFile(path, loaded) == 0);
+    std::remove(path);
+    assert(loaded.size() == 5 && loaded[0].match("1999-01") == 1);
+    assert(jp::Regex::deserializeFromFile(path, loaded) == jpcre2::ERROR::FILE_IO);
+
+    //empty
+    std::vector<jp::Regex> none;
+    assert(jp::Regex::serialize(none, bytes) == 0);
+    assert(jp::Regex::deserialize(bytes, loaded) == 0 && loaded.empty());
+    return 0;
+}